@@ -1326,6 +1326,7 @@ void do_user_addr_fault(struct pt_regs *regs,
 	if (!(flags & FAULT_FLAG_USER))
 		goto lock_mmap;
 
+retry_vma:
 	vma = lock_vma_under_rcu(mm, address);
 	if (!vma)
 		goto lock_mmap;
@@ -1344,8 +1345,6 @@ void do_user_addr_fault(struct pt_regs *regs,
 		goto done;
 	}
 	count_vm_vma_lock_event(VMA_LOCK_RETRY);
-	if (fault & VM_FAULT_MAJOR)
-		flags |= FAULT_FLAG_TRIED;
 
 	/* Quick path to respond to signals */
 	if (fault_signal_pending(fault, regs)) {
@@ -1355,6 +1354,17 @@ void do_user_addr_fault(struct pt_regs *regs,
 						 ARCH_DEFAULT_PKEY);
 		return;
 	}
+
+	/*
+	 * The handler dropped the VMA lock to wait for I/O. The page is most
+	 * likely uptodate now, so give the VMA lock one more go rather than
+	 * serializing on mmap_lock. With FAULT_FLAG_TRIED set the handler
+	 * waits for the page instead of asking for yet another retry.
+	 */
+	if ((fault & VM_FAULT_MAJOR) && !(flags & FAULT_FLAG_TRIED)) {
+		flags |= FAULT_FLAG_TRIED;
+		goto retry_vma;
+	}
 lock_mmap:
 
 retry:
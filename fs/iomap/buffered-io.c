@@ -8,6 +8,7 @@
 #include <linux/fs.h>
 #include <linux/iomap.h>
 #include <linux/pagemap.h>
+#include <linux/pagevec.h>
 #include <linux/uio.h>
 #include <linux/buffer_head.h>
 #include <linux/dax.h>
@@ -17,12 +18,20 @@
 #include <linux/bio.h>
 #include <linux/sched/signal.h>
 #include <linux/migrate.h>
+#include <linux/sizes.h>
 #include "trace.h"
 
 #include "../internal.h"
 
 #define IOEND_BATCH_SIZE	4096
 
+/*
+ * Maximum number of bytes handled by one batched buffered write iteration.
+ * All folios covering the range are held locked at the same time, so keep
+ * this bounded to not starve readers and writeback of the same range.
+ */
+#define IOMAP_WRITE_BATCH_BYTES	SZ_2M
+
 /*
  * Structure allocated for each folio to track per-block uptodate, dirty state
  * and I/O completions.
@@ -603,6 +612,8 @@ struct folio *iomap_get_folio(struct iomap_iter *iter, loff_t pos, size_t len)
 
 	if (iter->flags & IOMAP_NOWAIT)
 		fgp |= FGP_NOWAIT;
+	if (iter->flags & IOMAP_DONTCACHE)
+		fgp |= FGP_DONTCACHE;
 	fgp |= fgf_set_order(len);
 
 	return __filemap_get_folio(iter->inode->i_mapping, pos >> PAGE_SHIFT,
@@ -907,6 +918,115 @@ static bool iomap_write_end(struct iomap_iter *iter, loff_t pos, size_t len,
 	return __iomap_write_end(iter->inode, pos, len, copied, folio);
 }
 
+/*
+ * Batched writes lock a whole run of folios before copying any data into
+ * them, which is only safe if the filesystem does not need to do per-folio
+ * work (e.g. transaction handling) when getting and putting folios, and if
+ * the data ends up in the page cache proper.
+ */
+static bool iomap_write_can_batch(const struct iomap_iter *iter)
+{
+	const struct iomap_folio_ops *folio_ops = iter->iomap.folio_ops;
+	const struct iomap *srcmap = iomap_iter_srcmap(iter);
+
+	if (srcmap->type == IOMAP_INLINE)
+		return false;
+	if (srcmap->flags & IOMAP_F_BUFFER_HEAD)
+		return false;
+	if (folio_ops && (folio_ops->get_folio || folio_ops->put_folio))
+		return false;
+	return true;
+}
+
+/*
+ * Write up to @len bytes at @pos into a run of contiguous folios.  All folios
+ * of the run are locked and prepared first, then the user data is copied into
+ * them in a single pass over @i, and finally the folios are dirtied and
+ * released together.  This amortises the per-folio cost of dirty throttling,
+ * inode size updates and folio reference drops over the whole run.
+ *
+ * Returns the number of bytes written, which may be short, or a negative
+ * errno if nothing was written.  A return value of zero means the copy from
+ * user space failed and the caller should fall back to the single folio path.
+ */
+static ssize_t iomap_write_batch(struct iomap_iter *iter, struct iov_iter *i,
+		loff_t pos, size_t len)
+{
+	struct address_space *mapping = iter->inode->i_mapping;
+	struct folio_batch fbatch;
+	size_t mapped = 0, written = 0;
+	struct folio *folio;
+	bool failed = false;
+	loff_t old_size;
+	unsigned int n;
+	int status = 0;
+
+	folio_batch_init(&fbatch);
+	while (mapped < len && folio_batch_space(&fbatch)) {
+		status = iomap_write_begin(iter, pos + mapped, len - mapped,
+				&folio);
+		if (status) {
+			failed = true;
+			break;
+		}
+		if (iter->iomap.flags & IOMAP_F_STALE)
+			break;
+		folio_batch_add(&fbatch, folio);
+		mapped += min_t(size_t, len - mapped, folio_size(folio) -
+				offset_in_folio(folio, pos + mapped));
+	}
+
+	for (n = 0; n < folio_batch_count(&fbatch); n++) {
+		size_t offset, bytes, copied;
+
+		folio = fbatch.folios[n];
+		offset = offset_in_folio(folio, pos + written);
+		bytes = min(mapped - written, folio_size(folio) - offset);
+
+		if (mapping_writably_mapped(mapping))
+			flush_dcache_folio(folio);
+
+		copied = copy_folio_from_iter_atomic(folio, offset, bytes, i);
+		if (!iomap_write_end(iter, pos + written, bytes, copied,
+				folio)) {
+			iov_iter_revert(i, copied);
+			failed = true;
+			break;
+		}
+		written += copied;
+		if (copied < bytes) {
+			failed = true;
+			break;
+		}
+	}
+
+	/*
+	 * As in the single folio case the in-memory inode size must be updated
+	 * before any of the folios are unlocked.
+	 */
+	old_size = iter->inode->i_size;
+	if (pos + written > old_size) {
+		i_size_write(iter->inode, pos + written);
+		iter->iomap.flags |= IOMAP_F_SIZE_CHANGED;
+	}
+	for (n = 0; n < folio_batch_count(&fbatch); n++)
+		folio_unlock(fbatch.folios[n]);
+	folio_batch_release(&fbatch);
+
+	if (old_size < pos)
+		pagecache_isize_extended(iter->inode, old_size, pos);
+	/*
+	 * Only trim blocks beyond EOF that ->iomap_begin allocated when a
+	 * folio could not be set up or the copy came up short.  Stopping
+	 * because the batch is full or the mapping went stale is not a
+	 * failure, the caller simply continues with the rest of the range.
+	 */
+	if (failed)
+		iomap_write_failed(iter->inode, pos + written, len - written);
+
+	return written ? written : status;
+}
+
 static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 {
 	loff_t length = iomap_length(iter);
@@ -916,6 +1036,7 @@ static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 	struct address_space *mapping = iter->inode->i_mapping;
 	size_t chunk = mapping_max_folio_size(mapping);
 	unsigned int bdp_flags = (iter->flags & IOMAP_NOWAIT) ? BDP_ASYNC : 0;
+	bool batch = iomap_write_can_batch(iter);
 
 	do {
 		struct folio *folio;
@@ -926,6 +1047,50 @@ static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 		size_t written;		/* Bytes have been written */
 
 		bytes = iov_iter_count(i);
+
+		/*
+		 * If the write spans more than one folio, try to handle a run
+		 * of folios at once.  Fall back to one folio at a time if
+		 * copying from user space fails, the fallback path knows how
+		 * to make progress in that case.
+		 */
+		if (batch && min_t(loff_t, bytes, length) > chunk) {
+			ssize_t ret;
+
+			bytes = min_t(loff_t, length,
+				      min_t(size_t, bytes,
+					    IOMAP_WRITE_BATCH_BYTES));
+			status = balance_dirty_pages_ratelimited_flags(mapping,
+								bdp_flags);
+			if (unlikely(status))
+				break;
+			if (unlikely(fault_in_iov_iter_readable(i, bytes) ==
+					bytes)) {
+				status = -EFAULT;
+				break;
+			}
+
+			ret = iomap_write_batch(iter, i, pos, bytes);
+			if (ret < 0) {
+				status = ret;
+				break;
+			}
+			if (iter->iomap.flags & IOMAP_F_STALE) {
+				pos += ret;
+				total_written += ret;
+				break;
+			}
+
+			cond_resched();
+			if (ret > 0) {
+				pos += ret;
+				total_written += ret;
+				length -= ret;
+				continue;
+			}
+			batch = false;
+			bytes = iov_iter_count(i);
+		}
 retry:
 		offset = pos & (chunk - 1);
 		bytes = min(chunk - offset, bytes);
@@ -1034,6 +1199,8 @@ iomap_file_buffered_write(struct kiocb *iocb, struct iov_iter *i,
 
 	if (iocb->ki_flags & IOCB_NOWAIT)
 		iter.flags |= IOMAP_NOWAIT;
+	if (iocb->ki_flags & IOCB_DONTCACHE)
+		iter.flags |= IOMAP_DONTCACHE;
 
 	while ((ret = iomap_iter(&iter, ops)) > 0)
 		iter.processed = iomap_write_iter(&iter, i);
@@ -1574,6 +1574,28 @@ static int userfaultfd_wake(struct userfaultfd_ctx *ctx,
 	return ret;
 }
 
+static int userfaultfd_copy_prepare(struct userfaultfd_ctx *ctx,
+				    struct uffdio_copy *uffdio_copy,
+				    uffd_flags_t *flags)
+{
+	int ret;
+
+	ret = validate_unaligned_range(ctx->mm, uffdio_copy->src,
+				       uffdio_copy->len);
+	if (ret)
+		return ret;
+	ret = validate_range(ctx->mm, uffdio_copy->dst, uffdio_copy->len);
+	if (ret)
+		return ret;
+
+	if (uffdio_copy->mode & ~(UFFDIO_COPY_MODE_DONTWAKE|UFFDIO_COPY_MODE_WP))
+		return -EINVAL;
+	*flags = 0;
+	if (uffdio_copy->mode & UFFDIO_COPY_MODE_WP)
+		*flags |= MFILL_ATOMIC_WP;
+	return 0;
+}
+
 static int userfaultfd_copy(struct userfaultfd_ctx *ctx,
 			    unsigned long arg)
 {
@@ -1581,7 +1603,7 @@ static int userfaultfd_copy(struct userfaultfd_ctx *ctx,
 	struct uffdio_copy uffdio_copy;
 	struct uffdio_copy __user *user_uffdio_copy;
 	struct userfaultfd_wake_range range;
-	uffd_flags_t flags = 0;
+	uffd_flags_t flags;
 
 	user_uffdio_copy = (struct uffdio_copy __user *) arg;
 
@@ -1595,19 +1617,9 @@ static int userfaultfd_copy(struct userfaultfd_ctx *ctx,
 			   sizeof(uffdio_copy)-sizeof(__s64)))
 		goto out;
 
-	ret = validate_unaligned_range(ctx->mm, uffdio_copy.src,
-				       uffdio_copy.len);
-	if (ret)
-		goto out;
-	ret = validate_range(ctx->mm, uffdio_copy.dst, uffdio_copy.len);
+	ret = userfaultfd_copy_prepare(ctx, &uffdio_copy, &flags);
 	if (ret)
 		goto out;
-
-	ret = -EINVAL;
-	if (uffdio_copy.mode & ~(UFFDIO_COPY_MODE_DONTWAKE|UFFDIO_COPY_MODE_WP))
-		goto out;
-	if (uffdio_copy.mode & UFFDIO_COPY_MODE_WP)
-		flags |= MFILL_ATOMIC_WP;
 	if (mmget_not_zero(ctx->mm)) {
 		ret = mfill_atomic_copy(ctx, uffdio_copy.dst, uffdio_copy.src,
 					uffdio_copy.len, flags);
@@ -1631,6 +1643,91 @@ static int userfaultfd_copy(struct userfaultfd_ctx *ctx,
 	return ret;
 }
 
+/*
+ * Post-copy live migration and snapshot restore see storms of faults on
+ * unrelated addresses. Resolving them with one UFFDIO_COPY each costs a
+ * syscall and an mm reference per page, so let the monitor hand over a whole
+ * array of copies at once.
+ */
+static int userfaultfd_copy_batch(struct userfaultfd_ctx *ctx,
+				  unsigned long arg)
+{
+	__s64 ret;
+	struct uffdio_copy_batch uffdio_batch;
+	struct uffdio_copy_batch __user *user_uffdio_batch;
+	struct uffdio_copy __user *user_uffdio_copy;
+	struct uffdio_copy uffdio_copy;
+	struct userfaultfd_wake_range range;
+	uffd_flags_t flags;
+	__u64 copied = 0;
+
+	user_uffdio_batch = (struct uffdio_copy_batch __user *) arg;
+
+	ret = -EAGAIN;
+	if (atomic_read(&ctx->mmap_changing))
+		goto out_copied;
+
+	ret = -EFAULT;
+	if (copy_from_user(&uffdio_batch, user_uffdio_batch,
+			   /* don't copy "copied" last field */
+			   sizeof(uffdio_batch)-sizeof(__s64)))
+		goto out;
+
+	ret = -EINVAL;
+	if (uffdio_batch.mode || !uffdio_batch.nr)
+		goto out_copied;
+
+	ret = -ESRCH;
+	if (!mmget_not_zero(ctx->mm))
+		goto out_copied;
+
+	user_uffdio_copy = u64_to_user_ptr(uffdio_batch.copies);
+	for (; copied < uffdio_batch.nr; copied++, user_uffdio_copy++) {
+		if (copied && fatal_signal_pending(current)) {
+			ret = -EINTR;
+			break;
+		}
+
+		ret = -EFAULT;
+		if (copy_from_user(&uffdio_copy, user_uffdio_copy,
+				   /* don't copy "copy" last field */
+				   sizeof(uffdio_copy)-sizeof(__s64)))
+			break;
+
+		ret = userfaultfd_copy_prepare(ctx, &uffdio_copy, &flags);
+		if (ret)
+			break;
+		ret = mfill_atomic_copy(ctx, uffdio_copy.dst, uffdio_copy.src,
+					uffdio_copy.len, flags);
+		if (unlikely(put_user(ret, &user_uffdio_copy->copy))) {
+			ret = -EFAULT;
+			break;
+		}
+		if (ret < 0)
+			break;
+		BUG_ON(!ret);
+		/* len == 0 would wake all */
+		range.len = ret;
+		if (!(uffdio_copy.mode & UFFDIO_COPY_MODE_DONTWAKE)) {
+			range.start = uffdio_copy.dst;
+			wake_userfault(ctx, &range);
+		}
+		ret = 0;
+		if (range.len != uffdio_copy.len) {
+			ret = -EAGAIN;
+			break;
+		}
+		cond_resched();
+	}
+	mmput(ctx->mm);
+
+out_copied:
+	if (unlikely(put_user(copied, &user_uffdio_batch->copied)))
+		return -EFAULT;
+out:
+	return ret;
+}
+
 static int userfaultfd_zeropage(struct userfaultfd_ctx *ctx,
 				unsigned long arg)
 {
@@ -2030,6 +2127,9 @@ static long userfaultfd_ioctl(struct file *file, unsigned cmd,
 	case UFFDIO_POISON:
 		ret = userfaultfd_poison(ctx, arg);
 		break;
+	case UFFDIO_COPY_BATCH:
+		ret = userfaultfd_copy_batch(ctx, arg);
+		break;
 	}
 	return ret;
 }
@@ -101,6 +101,8 @@ bool compaction_zonelist_suitable(struct alloc_context *ac, int order,
 extern void __meminit kcompactd_run(int nid);
 extern void __meminit kcompactd_stop(int nid);
 extern void wakeup_kcompactd(pg_data_t *pgdat, int order, int highest_zoneidx);
+extern void compaction_note_demand(pg_data_t *pgdat, int order, bool failed);
+extern int compaction_predicted_order(void);
 
 #else
 static inline void reset_isolation_suitable(pg_data_t *pgdat)
@@ -125,6 +127,16 @@ static inline void wakeup_kcompactd(pg_data_t *pgdat,
 {
 }
 
+static inline void compaction_note_demand(pg_data_t *pgdat, int order,
+					  bool failed)
+{
+}
+
+static inline int compaction_predicted_order(void)
+{
+	return 0;
+}
+
 #endif /* CONFIG_COMPACTION */
 
 struct node;
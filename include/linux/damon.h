@@ -395,7 +395,8 @@ struct damos_access_pattern {
  *
  * @target_nid is used to set the migration target node for migrate_hot or
  * migrate_cold actions, which means it's only meaningful when @action is either
- * "migrate_hot" or "migrate_cold".
+ * "migrate_hot" or "migrate_cold".  If it is NUMA_NO_NODE, pages are migrated
+ * one memory tier up (migrate_hot) or down (migrate_cold) from their node.
  *
  * Before applying the &action to a memory region, &struct damon_operations
  * implementation could check pages of the region and skip &action to respect
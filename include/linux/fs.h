@@ -322,6 +322,7 @@ struct readahead_control;
 #define IOCB_NOWAIT		(__force int) RWF_NOWAIT
 #define IOCB_APPEND		(__force int) RWF_APPEND
 #define IOCB_ATOMIC		(__force int) RWF_ATOMIC
+#define IOCB_DONTCACHE		(__force int) RWF_DONTCACHE
 
 /* non-RWF related bits - start at 16 */
 #define IOCB_EVENTFD		(1 << 16)
@@ -357,6 +358,7 @@ struct readahead_control;
 	{ IOCB_NOWAIT,		"NOWAIT" }, \
 	{ IOCB_APPEND,		"APPEND" }, \
 	{ IOCB_ATOMIC,		"ATOMIC"}, \
+	{ IOCB_DONTCACHE,	"DONTCACHE" }, \
 	{ IOCB_EVENTFD,		"EVENTFD"}, \
 	{ IOCB_DIRECT,		"DIRECT" }, \
 	{ IOCB_WRITE,		"WRITE" }, \
@@ -463,10 +465,15 @@ extern const struct address_space_operations empty_aops;
  * @i_private_lock: For use by the owner of the address_space.
  * @i_private_list: For use by the owner of the address_space.
  * @i_private_data: For use by the owner of the address_space.
+ * @i_pages_delete_seqcnt: Incremented when folios are removed from or
+ *   replaced in @i_pages, protected by the i_pages lock.  Swap cache
+ *   address spaces never bump it, as they are not read through
+ *   filemap_read().
  */
 struct address_space {
 	struct inode		*host;
 	struct xarray		i_pages;
+	seqcount_spinlock_t	i_pages_delete_seqcnt;
 	struct rw_semaphore	invalidate_lock;
 	gfp_t			gfp_mask;
 	atomic_t		i_mmap_writable;
@@ -984,6 +991,8 @@ struct fown_struct {
  * @ra_pages: Maximum size of a readahead request, copied from the bdi.
  * @mmap_miss: How many mmap accesses missed in the page cache.
  * @prev_pos: The last byte in the most recent read request.
+ * @stride: Number of pages skipped between the two most recent reads.
+ * @stride_hits: How many consecutive reads repeated @stride after it was seen.
  *
  * When this structure is passed to ->readahead(), the "most recent"
  * readahead means the current readahead.
@@ -995,6 +1004,8 @@ struct file_ra_state {
 	unsigned int ra_pages;
 	unsigned int mmap_miss;
 	loff_t prev_pos;
+	unsigned int stride;
+	unsigned int stride_hits;
 };
 
 /*
@@ -2127,6 +2138,8 @@ struct file_operations {
 #define FOP_UNSIGNED_OFFSET	((__force fop_flags_t)(1 << 5))
 /* Supports asynchronous lock callbacks */
 #define FOP_ASYNC_LOCK		((__force fop_flags_t)(1 << 6))
+/* File system supports uncached read/write buffered IO */
+#define FOP_DONTCACHE		((__force fop_flags_t)(1 << 7))
 
 /* Wrap a directory iterator that needs exclusive inode access */
 int wrap_directory_iterator(struct file *, struct dir_context *,
@@ -2887,6 +2900,9 @@ extern int vfs_fsync(struct file *file, int datasync);
 extern int sync_file_range(struct file *file, loff_t offset, loff_t nbytes,
 				unsigned int flags);
 
+int filemap_fdatawrite_range_kick(struct address_space *mapping, loff_t start,
+		loff_t end);
+
 static inline bool iocb_is_dsync(const struct kiocb *iocb)
 {
 	return (iocb->ki_flags & IOCB_DSYNC) ||
@@ -2896,7 +2912,9 @@ static inline bool iocb_is_dsync(const struct kiocb *iocb)
 /*
  * Sync the bytes written if this was a synchronous write.  Expect ki_pos
  * to already be updated for the write, and will return either the amount
- * of bytes passed in, or an error if syncing the file failed.
+ * of bytes passed in, or an error if syncing the file failed.  Uncached
+ * writes start writeback of the range right away, so that the folios can be
+ * dropped from the page cache as soon as possible.
  */
 static inline ssize_t generic_write_sync(struct kiocb *iocb, ssize_t count)
 {
@@ -2906,6 +2924,9 @@ static inline ssize_t generic_write_sync(struct kiocb *iocb, ssize_t count)
 				(iocb->ki_flags & IOCB_SYNC) ? 0 : 1);
 		if (ret)
 			return ret;
+	} else if (iocb->ki_flags & IOCB_DONTCACHE) {
+		filemap_fdatawrite_range_kick(iocb->ki_filp->f_mapping,
+				iocb->ki_pos - count, iocb->ki_pos - 1);
 	}
 
 	return count;
@@ -3613,6 +3634,14 @@ static inline int kiocb_set_rw_flags(struct kiocb *ki, rwf_t flags,
 		if (!(ki->ki_filp->f_mode & FMODE_CAN_ATOMIC_WRITE))
 			return -EOPNOTSUPP;
 	}
+	if (flags & RWF_DONTCACHE) {
+		/* file system must support it */
+		if (!(ki->ki_filp->f_op->fop_flags & FOP_DONTCACHE))
+			return -EOPNOTSUPP;
+		/* DAX mappings not supported */
+		if (IS_DAX(ki->ki_filp->f_mapping->host))
+			return -EOPNOTSUPP;
+	}
 	kiocb_flags |= (__force int) (flags & RWF_SUPPORTED);
 	if (flags & RWF_SYNC)
 		kiocb_flags |= IOCB_DSYNC;
@@ -50,6 +50,7 @@ enum transparent_hugepage_flag {
 	TRANSPARENT_HUGEPAGE_DEFRAG_REQ_MADV_FLAG,
 	TRANSPARENT_HUGEPAGE_DEFRAG_KHUGEPAGED_FLAG,
 	TRANSPARENT_HUGEPAGE_USE_ZERO_PAGE_FLAG,
+	TRANSPARENT_HUGEPAGE_ADAPTIVE_ANON_ORDER_FLAG,
 };
 
 struct kobject;
@@ -310,6 +311,10 @@ struct thpsize {
 	(transparent_hugepage_flags &					\
 	 (1<<TRANSPARENT_HUGEPAGE_USE_ZERO_PAGE_FLAG))
 
+#define transparent_hugepage_adaptive_anon_order()			\
+	(transparent_hugepage_flags &					\
+	 (1<<TRANSPARENT_HUGEPAGE_ADAPTIVE_ANON_ORDER_FLAG))
+
 static inline bool vma_thp_disabled(struct vm_area_struct *vma,
 		unsigned long vm_flags)
 {
@@ -13,6 +13,8 @@ extern void __khugepaged_enter(struct mm_struct *mm);
 extern void __khugepaged_exit(struct mm_struct *mm);
 extern void khugepaged_enter_vma(struct vm_area_struct *vma,
 				 unsigned long vm_flags);
+extern void khugepaged_defer_fault(struct vm_area_struct *vma,
+				   unsigned long haddr);
 extern void khugepaged_min_free_kbytes_update(void);
 extern bool current_is_khugepaged(void);
 #ifdef CONFIG_SHMEM
@@ -780,6 +780,16 @@ struct vm_area_struct {
 #endif
 #ifdef CONFIG_NUMA_BALANCING
 	struct vma_numab_state *numab_state;	/* NUMA Balancing state */
+#endif
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	/*
+	 * Largest anonymous mTHP order picked on fault, 0 for no limit, and
+	 * the fault density samples it is learned from. Updated racily by
+	 * the fault path, see anon_fault_orders().
+	 */
+	unsigned char anon_order_cap;
+	unsigned char anon_order_dense;
+	unsigned char anon_order_sparse;
 #endif
 	struct vm_userfaultfd_ctx vm_userfaultfd_ctx;
 } __randomize_layout;
@@ -800,6 +810,9 @@ struct mm_cid {
 
 struct kioctx_table;
 struct iommu_mm_data;
+/* Number of fallen back THP faults remembered per mm */
+#define KHUGEPAGED_MAX_DEFERRED	8
+
 struct mm_struct {
 	struct {
 		/*
@@ -995,6 +1008,17 @@ struct mm_struct {
 #if defined(CONFIG_TRANSPARENT_HUGEPAGE) && !defined(CONFIG_SPLIT_PMD_PTLOCKS)
 		pgtable_t pmd_huge_pte; /* protected by page_table_lock */
 #endif
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+		/*
+		 * PMD aligned addresses whose THP fault fell back to base
+		 * pages, collapsed by khugepaged before its linear scan.
+		 * Filled locklessly as a ring, see khugepaged_defer_fault().
+		 */
+		unsigned long khugepaged_deferred[KHUGEPAGED_MAX_DEFERRED];
+		atomic_t khugepaged_deferred_next;
+		/* Set while the mm is queued for khugepaged to collapse them */
+		atomic_t khugepaged_deferred_queued;
+#endif
 #ifdef CONFIG_NUMA_BALANCING
 		/*
 		 * numa_next_scan is the next time that PTEs will be remapped
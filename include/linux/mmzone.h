@@ -698,6 +698,8 @@ struct per_cpu_pages {
 	u8 expire;		/* When 0, remote pagesets are drained */
 #endif
 	short free_count;	/* consecutive free count */
+	int zone_xfer;		/* pages moved from/to zone since last decay */
+	int high_demand;	/* decayed average of zone_xfer */
 
 	/* Lists of pages, one per migrate type stored on the pcp-lists */
 	struct list_head lists[NR_PCP_LISTS];
@@ -1366,6 +1368,9 @@ typedef struct pglist_data {
 	wait_queue_head_t kcompactd_wait;
 	struct task_struct *kcompactd;
 	bool proactive_compact_trigger;
+	/* Decayed high-order allocation slowpath entries and failures */
+	unsigned int compact_demand[NR_PAGE_ORDERS];
+	int compact_predicted_order;
 #endif
 	/*
 	 * This is a per-node reserve of pages that are not available
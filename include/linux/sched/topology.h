@@ -82,6 +82,7 @@ struct sched_domain_shared {
 	atomic_t	nr_busy_cpus;
 	int		has_idle_cores;
 	int		nr_idle_scan;
+	unsigned long	util_avg;	/* LLC utilization, for WA_CACHE */
 };
 
 struct sched_domain {
@@ -58,6 +58,9 @@ enum _slab_flag_bits {
 	_SLAB_CMPXCHG_DOUBLE,
 #ifdef CONFIG_SLAB_OBJ_EXT
 	_SLAB_NO_OBJ_EXT,
+#endif
+#ifndef CONFIG_SLUB_TINY
+	_SLAB_PERCPU_ARRAY,
 #endif
 	_SLAB_FLAGS_LAST_BIT
 };
@@ -234,6 +237,21 @@ enum _slab_flag_bits {
 #define SLAB_NO_OBJ_EXT		__SLAB_FLAG_UNUSED
 #endif
 
+/**
+ * define SLAB_PERCPU_ARRAY - Cache freed objects in a per-cpu array.
+ *
+ * Objects freed on a cpu are kept in a per-cpu array and handed out again by
+ * allocations on that cpu without touching the slab freelists. The array is
+ * refilled from and flushed to the slabs in bulk. This trades some memory for
+ * cheaper allocation and freeing, and is meant for a few caches with very
+ * high object churn. Ignored when debugging is enabled for the cache.
+ */
+#ifndef CONFIG_SLUB_TINY
+#define SLAB_PERCPU_ARRAY	__SLAB_FLAG_BIT(_SLAB_PERCPU_ARRAY)
+#else
+#define SLAB_PERCPU_ARRAY	__SLAB_FLAG_UNUSED
+#endif
+
 /*
  * freeptr_t represents a SLUB freelist pointer, which might be encoded
  * and not dereferenceable if CONFIG_SLAB_FREELIST_HARDENED is enabled.
@@ -41,6 +41,7 @@ enum vm_stat_item {
 	NR_DIRTY_BG_THRESHOLD,
 	NR_MEMMAP_PAGES,	/* page metadata allocated through buddy allocator */
 	NR_MEMMAP_BOOT_PAGES,	/* page metadata allocated through boot allocator */
+	COMPACT_PREDICTED_ORDER, /* highest order kcompactd expects demand for */
 	NR_VM_STAT_ITEMS,
 };
 
@@ -163,6 +163,15 @@ struct wb_domain {
 	 */
 	unsigned long dirty_limit_tstamp;
 	unsigned long dirty_limit;
+
+	/*
+	 * Background threshold and freerun ceiling last computed by
+	 * balance_dirty_pages(), used to skip recomputing the limits while
+	 * dirty pages are well below them. Accessed locklessly.
+	 */
+	unsigned long fast_limit_tstamp;
+	unsigned long fast_bg_thresh;
+	unsigned long fast_freerun;
 };
 
 /**
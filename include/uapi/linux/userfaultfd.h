@@ -54,13 +54,15 @@
 	 (__u64)1 << _UFFDIO_MOVE |		\
 	 (__u64)1 << _UFFDIO_WRITEPROTECT |	\
 	 (__u64)1 << _UFFDIO_CONTINUE |		\
-	 (__u64)1 << _UFFDIO_POISON)
+	 (__u64)1 << _UFFDIO_POISON |		\
+	 (__u64)1 << _UFFDIO_COPY_BATCH)
 #define UFFD_API_RANGE_IOCTLS_BASIC		\
 	((__u64)1 << _UFFDIO_WAKE |		\
 	 (__u64)1 << _UFFDIO_COPY |		\
 	 (__u64)1 << _UFFDIO_WRITEPROTECT |	\
 	 (__u64)1 << _UFFDIO_CONTINUE |		\
-	 (__u64)1 << _UFFDIO_POISON)
+	 (__u64)1 << _UFFDIO_POISON |		\
+	 (__u64)1 << _UFFDIO_COPY_BATCH)
 
 /*
  * Valid ioctl command number range with this API is from 0x00 to
@@ -79,6 +81,7 @@
 #define _UFFDIO_WRITEPROTECT		(0x06)
 #define _UFFDIO_CONTINUE		(0x07)
 #define _UFFDIO_POISON			(0x08)
+#define _UFFDIO_COPY_BATCH		(0x09)
 #define _UFFDIO_API			(0x3F)
 
 /* userfaultfd ioctl ids */
@@ -103,6 +106,8 @@
 				      struct uffdio_continue)
 #define UFFDIO_POISON		_IOWR(UFFDIO, _UFFDIO_POISON, \
 				      struct uffdio_poison)
+#define UFFDIO_COPY_BATCH	_IOWR(UFFDIO, _UFFDIO_COPY_BATCH, \
+				      struct uffdio_copy_batch)
 
 /* read() structure */
 struct uffd_msg {
@@ -293,6 +298,27 @@ struct uffdio_copy {
 	__s64 copy;
 };
 
+/*
+ * Resolve many, possibly discontiguous, faults with a single ioctl.
+ * "copies" points to an array of "nr" struct uffdio_copy, which are
+ * processed in order exactly as by UFFDIO_COPY, including their "mode"
+ * and the "copy" result field. Processing stops at the first entry that
+ * is not fully copied.
+ */
+struct uffdio_copy_batch {
+	__u64 copies;
+	__u64 nr;
+	/* no batch-wide modes are defined yet, must be zero */
+	__u64 mode;
+
+	/*
+	 * "copied" is written by the ioctl and must be at the end: the
+	 * copy_from_user will not read the last 8 bytes. It is set to the
+	 * number of entries that were fully copied.
+	 */
+	__s64 copied;
+};
+
 struct uffdio_zeropage {
 	struct uffdio_range range;
 #define UFFDIO_ZEROPAGE_MODE_DONTWAKE		((__u64)1<<0)
@@ -299,6 +299,56 @@ static inline void __cgroup_rstat_unlock(struct cgroup *cgrp, int cpu_in_loop)
 	spin_unlock_irq(&cgroup_rstat_lock);
 }
 
+/*
+ * Number of flushes in progress.  cgroup_rstat_updated_list() takes cgroups
+ * off the updated tree before their stats have been propagated, so an empty
+ * updated tree only means the subtree is up to date when nobody is flushing.
+ */
+static atomic_t cgroup_rstat_flushers = ATOMIC_INIT(0);
+
+static void cgroup_rstat_flush_begin(void)
+{
+	atomic_inc(&cgroup_rstat_flushers);
+	/* pairs with smp_rmb() in cgroup_rstat_pending() */
+	smp_mb__after_atomic();
+}
+
+static void cgroup_rstat_flush_end(void)
+{
+	/* propagated stats must be visible before the count drops */
+	smp_mb__before_atomic();
+	atomic_dec(&cgroup_rstat_flushers);
+}
+
+/*
+ * Lockless test for whether @cgrp's subtree has anything queued for flushing
+ * on @cpu. cgroup_rstat_updated() links every ancestor of an updated cgroup
+ * into the updated tree, so if @cgrp itself is not linked, nothing below it
+ * is either. This may race with a concurrent update, which is no different
+ * from the update arriving right after the flush.
+ */
+static bool cgroup_rstat_cpu_pending(struct cgroup *cgrp, int cpu)
+{
+	return data_race(cgroup_rstat_cpu(cgrp, cpu)->updated_next);
+}
+
+static bool cgroup_rstat_pending(struct cgroup *cgrp)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		if (cgroup_rstat_cpu_pending(cgrp, cpu))
+			return true;
+	}
+
+	/*
+	 * A flush that has taken cgroups off the updated tree may still be
+	 * propagating their stats.  Wait for it by taking the lock.
+	 */
+	smp_rmb();
+	return atomic_read_acquire(&cgroup_rstat_flushers);
+}
+
 /* see cgroup_rstat_flush() */
 static void cgroup_rstat_flush_locked(struct cgroup *cgrp)
 	__releases(&cgroup_rstat_lock) __acquires(&cgroup_rstat_lock)
@@ -308,8 +358,13 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp)
 	lockdep_assert_held(&cgroup_rstat_lock);
 
 	for_each_possible_cpu(cpu) {
-		struct cgroup *pos = cgroup_rstat_updated_list(cgrp, cpu);
+		struct cgroup *pos;
+
+		/* don't bounce the per-cpu lock of cpus with nothing to flush */
+		if (!cgroup_rstat_cpu_pending(cgrp, cpu))
+			continue;
 
+		pos = cgroup_rstat_updated_list(cgrp, cpu);
 		for (; pos; pos = pos->rstat_flush_next) {
 			struct cgroup_subsys_state *css;
 
@@ -344,15 +399,25 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp)
  * This also gets all cgroups in the subtree including @cgrp off the
  * ->updated_children lists.
  *
+ * If nothing in the subtree has been updated since the last flush and no
+ * other flush is in progress, this returns without taking the global rstat
+ * lock, so readers of quiet subtrees don't serialize behind flushers of busy
+ * ones.
+ *
  * This function may block.
  */
 __bpf_kfunc void cgroup_rstat_flush(struct cgroup *cgrp)
 {
 	might_sleep();
 
+	if (!cgroup_rstat_pending(cgrp))
+		return;
+
+	cgroup_rstat_flush_begin();
 	__cgroup_rstat_lock(cgrp, -1);
 	cgroup_rstat_flush_locked(cgrp);
 	__cgroup_rstat_unlock(cgrp, -1);
+	cgroup_rstat_flush_end();
 }
 
 /**
@@ -368,6 +433,7 @@ void cgroup_rstat_flush_hold(struct cgroup *cgrp)
 	__acquires(&cgroup_rstat_lock)
 {
 	might_sleep();
+	cgroup_rstat_flush_begin();
 	__cgroup_rstat_lock(cgrp, -1);
 	cgroup_rstat_flush_locked(cgrp);
 }
@@ -380,6 +446,7 @@ void cgroup_rstat_flush_release(struct cgroup *cgrp)
 	__releases(&cgroup_rstat_lock)
 {
 	__cgroup_rstat_unlock(cgrp, -1);
+	cgroup_rstat_flush_end();
 }
 
 int cgroup_rstat_init(struct cgroup *cgrp)
@@ -1281,6 +1281,11 @@ static struct mm_struct *mm_init(struct mm_struct *mm, struct task_struct *p,
 	init_tlb_flush_pending(mm);
 #if defined(CONFIG_TRANSPARENT_HUGEPAGE) && !defined(CONFIG_SPLIT_PMD_PTLOCKS)
 	mm->pmd_huge_pte = NULL;
+#endif
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	memset(mm->khugepaged_deferred, 0, sizeof(mm->khugepaged_deferred));
+	atomic_set(&mm->khugepaged_deferred_next, 0);
+	atomic_set(&mm->khugepaged_deferred_queued, 0);
 #endif
 	mm_init_uprobes_state(mm);
 	hugetlb_count_init(mm);
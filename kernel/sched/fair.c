@@ -7359,6 +7359,34 @@ wake_affine_weight(struct sched_domain *sd, struct task_struct *p,
 	return this_eff_load < prev_eff_load ? this_cpu : nr_cpumask_bits;
 }
 
+/*
+ * On machines with many LLCs per node (e.g. several CCXs per socket), pulling
+ * the wakee into the waker's LLC throws away its cache footprint, and tasks
+ * of a request/response pair waking each other keep bouncing between LLCs.
+ * Stay in the previous LLC as long as it is not overloaded, using the same
+ * 85% threshold at which SIS_UTIL stops scanning it. select_idle_sibling()
+ * then looks for an idle CPU there with its usual bounded scan.
+ */
+static bool wake_affine_prev_llc(int this_cpu, int prev_cpu)
+{
+	struct sched_domain_shared *sds;
+	struct sched_domain *sd;
+
+	if (cpus_share_cache(this_cpu, prev_cpu))
+		return false;
+
+	if (available_idle_cpu(prev_cpu) || sched_idle_cpu(prev_cpu))
+		return true;
+
+	sd = rcu_dereference(per_cpu(sd_llc, prev_cpu));
+	sds = rcu_dereference(per_cpu(sd_llc_shared, prev_cpu));
+	if (!sd || !sds)
+		return false;
+
+	return READ_ONCE(sds->util_avg) * sd->imbalance_pct <
+	       (unsigned long)sd->span_weight * SCHED_CAPACITY_SCALE * 100;
+}
+
 static int wake_affine(struct sched_domain *sd, struct task_struct *p,
 		       int this_cpu, int prev_cpu, int sync)
 {
@@ -7374,6 +7402,9 @@ static int wake_affine(struct sched_domain *sd, struct task_struct *p,
 	if (target != this_cpu)
 		return prev_cpu;
 
+	if (sched_feat(WA_CACHE) && wake_affine_prev_llc(this_cpu, prev_cpu))
+		return prev_cpu;
+
 	schedstat_inc(sd->ttwu_move_affine);
 	schedstat_inc(p->stats.nr_wakeups_affine);
 	return target;
@@ -10844,13 +10875,16 @@ static void update_idle_cpu_scan(struct lb_env *env,
 	u64 x, y, tmp;
 	/*
 	 * Update the number of CPUs to scan in LLC domain, which could
-	 * be used as a hint in select_idle_cpu(). The update of sd_share
+	 * be used as a hint in select_idle_cpu(), and the LLC utilization
+	 * used by wake_affine_prev_llc(). The update of sd_share
 	 * could be expensive because it is within a shared cache line.
-	 * So the write of this hint only occurs during periodic load
+	 * So the write of these hints only occurs during periodic load
 	 * balancing, rather than CPU_NEWLY_IDLE, because the latter
 	 * can fire way more frequently than the former.
 	 */
-	if (!sched_feat(SIS_UTIL) || env->idle == CPU_NEWLY_IDLE)
+	if (env->idle == CPU_NEWLY_IDLE)
+		return;
+	if (!sched_feat(SIS_UTIL) && !sched_feat(WA_CACHE))
 		return;
 
 	llc_weight = per_cpu(sd_llc_size, env->dst_cpu);
@@ -10861,6 +10895,12 @@ static void update_idle_cpu_scan(struct lb_env *env,
 	if (!sd_share)
 		return;
 
+	if (sched_feat(WA_CACHE))
+		WRITE_ONCE(sd_share->util_avg, sum_util);
+
+	if (!sched_feat(SIS_UTIL))
+		return;
+
 	/*
 	 * The number of CPUs to search drops as sum_util increases, when
 	 * sum_util hits 85% or above, the scan stops.
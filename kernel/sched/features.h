@@ -105,6 +105,11 @@ SCHED_FEAT(ATTACH_AGE_LOAD, true)
 SCHED_FEAT(WA_IDLE, true)
 SCHED_FEAT(WA_WEIGHT, true)
 SCHED_FEAT(WA_BIAS, true)
+/*
+ * Don't let an affine wakeup pull a task out of its previous LLC while
+ * that LLC has spare capacity.
+ */
+SCHED_FEAT(WA_CACHE, false)
 
 /*
  * UtilEstimation. Use estimated CPU utilization.
@@ -32,6 +32,16 @@
  */
 #define HPAGE_FRAG_CHECK_INTERVAL_MSEC	(500)
 
+/*
+ * High-order demand tracking. Every allocation that enters the slowpath
+ * adds one to its order's counter in the preferred node, a failure adds
+ * COMPACT_DEMAND_FAIL_WEIGHT more. kcompactd halves the counters every
+ * HPAGE_FRAG_CHECK_INTERVAL_MSEC and compacts for the highest order whose
+ * counter is at least COMPACT_DEMAND_THRESHOLD.
+ */
+#define COMPACT_DEMAND_FAIL_WEIGHT	4
+#define COMPACT_DEMAND_THRESHOLD	8
+
 static inline void count_compact_event(enum vm_event_item item)
 {
 	count_vm_event(item);
@@ -1921,6 +1931,11 @@ static int sysctl_compact_unevictable_allowed __read_mostly = CONFIG_COMPACT_UNE
  * background. It takes values in the range [0, 100].
  */
 static unsigned int __read_mostly sysctl_compaction_proactiveness = 20;
+/*
+ * Tunable for demand-driven compaction. When set, kcompactd compacts for the
+ * orders recent allocations asked for, independently of proactiveness.
+ */
+static int __read_mostly sysctl_compaction_demand = 1;
 static int sysctl_extfrag_threshold = 500;
 static int __read_mostly sysctl_compact_memory;
 
@@ -3121,6 +3136,103 @@ static void kcompactd_do_work(pg_data_t *pgdat)
 		pgdat->kcompactd_highest_zoneidx = pgdat->nr_zones - 1;
 }
 
+/*
+ * Updates are racy and may be lost, which is fine for a heuristic that
+ * only decides when kcompactd compacts ahead of demand. kcompactd may be
+ * sleeping without a timeout, so wake it when an order crosses the
+ * threshold.
+ */
+void compaction_note_demand(pg_data_t *pgdat, int order, bool failed)
+{
+	unsigned int weight = failed ? COMPACT_DEMAND_FAIL_WEIGHT : 1;
+	unsigned int demand;
+
+	if (order > MAX_PAGE_ORDER || !READ_ONCE(sysctl_compaction_demand))
+		return;
+
+	demand = READ_ONCE(pgdat->compact_demand[order]);
+	WRITE_ONCE(pgdat->compact_demand[order], demand + weight);
+
+	if (demand < COMPACT_DEMAND_THRESHOLD &&
+	    demand + weight >= COMPACT_DEMAND_THRESHOLD)
+		wakeup_kcompactd(pgdat, order, pgdat->nr_zones - 1);
+}
+
+/* The highest order currently predicted on any node, for /proc/vmstat */
+int compaction_predicted_order(void)
+{
+	int nid, order = 0;
+
+	for_each_online_node(nid)
+		order = max(order, READ_ONCE(NODE_DATA(nid)->compact_predicted_order));
+
+	return order;
+}
+
+static bool kcompactd_demand_pending(pg_data_t *pgdat)
+{
+	int order;
+
+	if (!READ_ONCE(sysctl_compaction_demand))
+		return false;
+
+	for (order = 1; order < NR_PAGE_ORDERS; order++)
+		if (READ_ONCE(pgdat->compact_demand[order]))
+			return true;
+
+	return false;
+}
+
+/*
+ * Decay the demand histogram and return the highest order with enough
+ * recent demand to be worth compacting for, or 0.
+ */
+static int kcompactd_update_demand(pg_data_t *pgdat)
+{
+	int order, predicted = 0;
+
+	for (order = 1; order < NR_PAGE_ORDERS; order++) {
+		unsigned int demand = READ_ONCE(pgdat->compact_demand[order]);
+
+		if (demand >= COMPACT_DEMAND_THRESHOLD)
+			predicted = order;
+		WRITE_ONCE(pgdat->compact_demand[order], demand >> 1);
+	}
+
+	WRITE_ONCE(pgdat->compact_predicted_order, predicted);
+	return predicted;
+}
+
+/*
+ * Compact the node for the predicted order if a page of that order is not
+ * already available. Like a kswapd wakeup, this stops as soon as the order
+ * is allocatable above the min watermark, so no more work is done than
+ * what the recent demand asks for.
+ */
+static bool kcompactd_demand_compact(pg_data_t *pgdat)
+{
+	int order;
+
+	if (!READ_ONCE(sysctl_compaction_demand))
+		return false;
+
+	order = kcompactd_update_demand(pgdat);
+	if (!order)
+		return false;
+
+	if (pgdat->kcompactd_max_order < order)
+		pgdat->kcompactd_max_order = order;
+
+	if (!kcompactd_node_suitable(pgdat)) {
+		pgdat->kcompactd_max_order = 0;
+		return false;
+	}
+
+	count_compact_event(KCOMPACTD_DEMAND_WAKE);
+	kcompactd_do_work(pgdat);
+	return true;
+}
+
 void wakeup_kcompactd(pg_data_t *pgdat, int order, int highest_zoneidx)
 {
 	if (!order)
@@ -3173,9 +3285,11 @@ static int kcompactd(void *p)
 
 		/*
 		 * Avoid the unnecessary wakeup for proactive compaction
-		 * when it is disabled.
+		 * when it is disabled and there is no recent high-order
+		 * demand to decay.
 		 */
-		if (!sysctl_compaction_proactiveness)
+		if (!sysctl_compaction_proactiveness &&
+		    !kcompactd_demand_pending(pgdat))
 			timeout = MAX_SCHEDULE_TIMEOUT;
 		trace_mm_compaction_kcompactd_sleep(pgdat->node_id);
 		if (wait_event_freezable_timeout(pgdat->kcompactd_wait,
@@ -3196,6 +3310,22 @@ static int kcompactd(void *p)
 			continue;
 		}
 
+		/*
+		 * Compact for the orders that are actually being asked for
+		 * before falling back to the fragmentation score.
+		 */
+		if (!pgdat->proactive_compact_trigger) {
+			bool compacted;
+
+			psi_memstall_enter(&pflags);
+			compacted = kcompactd_demand_compact(pgdat);
+			psi_memstall_leave(&pflags);
+			if (compacted) {
+				timeout = default_timeout;
+				continue;
+			}
+		}
+
 		/*
 		 * Start the proactive work with default timeout. Based
 		 * on the fragmentation score, this timeout is updated.
@@ -3314,6 +3444,15 @@ static struct ctl_table vm_compaction[] = {
 		.extra1		= SYSCTL_ZERO,
 		.extra2		= SYSCTL_ONE_HUNDRED,
 	},
+	{
+		.procname	= "compaction_demand",
+		.data		= &sysctl_compaction_demand,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= SYSCTL_ONE,
+	},
 	{
 		.procname	= "extfrag_threshold",
 		.data		= &sysctl_extfrag_threshold,
@@ -76,12 +76,122 @@ static void __damon_pa_prepare_access_check(struct damon_region *r)
 	damon_pa_mkold(r->sampling_addr);
 }
 
+/*
+ * Sampling a region means an rmap walk, which dominates kdamond's time when a
+ * physical address space is split into many regions. Targets with at least
+ * this many regions are sampled by up to DAMON_PA_MAX_WORKERS work items, one
+ * per online NUMA node, each handling a contiguous slice of the regions.
+ */
+#define DAMON_PA_PARALLEL_MIN_REGIONS	4096
+#define DAMON_PA_MAX_WORKERS		8
+
+/* Reuse of the access check result of the last checked folio */
+struct damon_pa_check_cache {
+	unsigned long last_addr;
+	unsigned long last_folio_sz;
+	bool last_accessed;
+};
+
+struct damon_pa_access_work {
+	struct work_struct work;
+	struct damon_ctx *ctx;
+	struct damon_region *first;
+	unsigned int nr_regions;
+	bool prepare;
+	unsigned int max_nr_accesses;
+};
+
+static void __damon_pa_check_access(struct damon_region *r,
+		struct damon_attrs *attrs, struct damon_pa_check_cache *cache);
+
+static void damon_pa_access_work_fn(struct work_struct *work)
+{
+	struct damon_pa_access_work *w = container_of(work,
+			struct damon_pa_access_work, work);
+	struct damon_pa_check_cache cache = {
+		.last_folio_sz = PAGE_SIZE,
+	};
+	struct damon_region *r = w->first;
+	unsigned int i;
+
+	for (i = 0; i < w->nr_regions; i++, r = damon_next_region(r)) {
+		if (w->prepare) {
+			__damon_pa_prepare_access_check(r);
+		} else {
+			__damon_pa_check_access(r, &w->ctx->attrs, &cache);
+			w->max_nr_accesses = max(r->nr_accesses,
+					w->max_nr_accesses);
+		}
+		cond_resched();
+	}
+}
+
+/*
+ * Each region is handled by exactly one work item and the region list is not
+ * changed while they run, so the only merging needed afterwards is of the
+ * maximum number of accesses.
+ */
+static unsigned int damon_pa_access_parallel(struct damon_ctx *ctx,
+		struct damon_target *t, bool prepare)
+{
+	struct damon_pa_access_work works[DAMON_PA_MAX_WORKERS];
+	unsigned int nr_works, per_work, left = t->nr_regions;
+	struct damon_region *r = damon_first_region(t);
+	unsigned int max_nr_accesses = 0;
+	int nid = first_online_node;
+	unsigned int i, j;
+
+	nr_works = min_t(unsigned int, num_online_nodes(), DAMON_PA_MAX_WORKERS);
+	per_work = DIV_ROUND_UP(left, nr_works);
+
+	for (i = 0; i < nr_works && left; i++) {
+		struct damon_pa_access_work *w = &works[i];
+
+		w->ctx = ctx;
+		w->first = r;
+		w->nr_regions = min(per_work, left);
+		w->prepare = prepare;
+		w->max_nr_accesses = 0;
+		INIT_WORK_ONSTACK(&w->work, damon_pa_access_work_fn);
+		queue_work_node(nid, system_unbound_wq, &w->work);
+
+		left -= w->nr_regions;
+		if (left) {
+			for (j = 0; j < w->nr_regions; j++)
+				r = damon_next_region(r);
+		}
+		nid = next_online_node(nid);
+		if (nid == MAX_NUMNODES)
+			nid = first_online_node;
+	}
+	nr_works = i;
+
+	for (i = 0; i < nr_works; i++) {
+		flush_work(&works[i].work);
+		destroy_work_on_stack(&works[i].work);
+		max_nr_accesses = max(works[i].max_nr_accesses,
+				max_nr_accesses);
+	}
+
+	return max_nr_accesses;
+}
+
+static bool damon_pa_use_parallel(struct damon_target *t)
+{
+	return t->nr_regions >= DAMON_PA_PARALLEL_MIN_REGIONS &&
+		num_online_nodes() > 1;
+}
+
 static void damon_pa_prepare_access_checks(struct damon_ctx *ctx)
 {
 	struct damon_target *t;
 	struct damon_region *r;
 
 	damon_for_each_target(t, ctx) {
+		if (damon_pa_use_parallel(t)) {
+			damon_pa_access_parallel(ctx, t, true);
+			continue;
+		}
 		damon_for_each_region(r, t)
 			__damon_pa_prepare_access_check(r);
 	}
@@ -163,34 +273,39 @@ static bool damon_pa_young(unsigned long paddr, unsigned long *folio_sz)
 }
 
 static void __damon_pa_check_access(struct damon_region *r,
-		struct damon_attrs *attrs)
+		struct damon_attrs *attrs, struct damon_pa_check_cache *cache)
 {
-	static unsigned long last_addr;
-	static unsigned long last_folio_sz = PAGE_SIZE;
-	static bool last_accessed;
-
 	/* If the region is in the last checked page, reuse the result */
-	if (ALIGN_DOWN(last_addr, last_folio_sz) ==
-				ALIGN_DOWN(r->sampling_addr, last_folio_sz)) {
-		damon_update_region_access_rate(r, last_accessed, attrs);
+	if (ALIGN_DOWN(cache->last_addr, cache->last_folio_sz) ==
+			ALIGN_DOWN(r->sampling_addr, cache->last_folio_sz)) {
+		damon_update_region_access_rate(r, cache->last_accessed, attrs);
 		return;
 	}
 
-	last_accessed = damon_pa_young(r->sampling_addr, &last_folio_sz);
-	damon_update_region_access_rate(r, last_accessed, attrs);
+	cache->last_accessed = damon_pa_young(r->sampling_addr,
+			&cache->last_folio_sz);
+	damon_update_region_access_rate(r, cache->last_accessed, attrs);
 
-	last_addr = r->sampling_addr;
+	cache->last_addr = r->sampling_addr;
 }
 
 static unsigned int damon_pa_check_accesses(struct damon_ctx *ctx)
 {
+	static struct damon_pa_check_cache cache = {
+		.last_folio_sz = PAGE_SIZE,
+	};
 	struct damon_target *t;
 	struct damon_region *r;
 	unsigned int max_nr_accesses = 0;
 
 	damon_for_each_target(t, ctx) {
+		if (damon_pa_use_parallel(t)) {
+			max_nr_accesses = max(damon_pa_access_parallel(ctx, t,
+						false), max_nr_accesses);
+			continue;
+		}
 		damon_for_each_region(r, t) {
-			__damon_pa_check_access(r, &ctx->attrs);
+			__damon_pa_check_access(r, &ctx->attrs, &cache);
 			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
 		}
 	}
@@ -360,8 +475,27 @@ static unsigned int __damon_pa_migrate_folio_list(
 	return nr_succeeded;
 }
 
+/*
+ * Without an explicit target node, hot pages move one memory tier up and cold
+ * pages one tier down from the node they are on. This lets a single
+ * migrate_hot scheme on a slow tier node act as a promotion engine that
+ * doesn't depend on NUMA hinting faults.
+ */
+static int damon_pa_migrate_target(enum damos_action action,
+				   struct pglist_data *pgdat, int target_nid)
+{
+	if (target_nid != NUMA_NO_NODE)
+		return target_nid;
+
+	if (action == DAMOS_MIGRATE_HOT)
+		return next_promotion_node(pgdat->node_id);
+
+	return next_demotion_node(pgdat->node_id);
+}
+
 static unsigned int damon_pa_migrate_folio_list(struct list_head *folio_list,
 						struct pglist_data *pgdat,
+						enum damos_action action,
 						int target_nid)
 {
 	unsigned int nr_migrated = 0;
@@ -369,6 +503,8 @@ static unsigned int damon_pa_migrate_folio_list(struct list_head *folio_list,
 	LIST_HEAD(ret_folios);
 	LIST_HEAD(migrate_folios);
 
+	target_nid = damon_pa_migrate_target(action, pgdat, target_nid);
+
 	while (!list_empty(folio_list)) {
 		struct folio *folio;
 
@@ -413,6 +549,7 @@ static unsigned int damon_pa_migrate_folio_list(struct list_head *folio_list,
 }
 
 static unsigned long damon_pa_migrate_pages(struct list_head *folio_list,
+					    enum damos_action action,
 					    int target_nid)
 {
 	int nid;
@@ -436,13 +573,13 @@ static unsigned long damon_pa_migrate_pages(struct list_head *folio_list,
 
 		nr_migrated += damon_pa_migrate_folio_list(&node_folio_list,
 							   NODE_DATA(nid),
-							   target_nid);
+							   action, target_nid);
 		nid = folio_nid(lru_to_folio(folio_list));
 	} while (!list_empty(folio_list));
 
 	nr_migrated += damon_pa_migrate_folio_list(&node_folio_list,
 						   NODE_DATA(nid),
-						   target_nid);
+						   action, target_nid);
 
 	memalloc_noreclaim_restore(noreclaim_flag);
 
@@ -469,7 +606,7 @@ static unsigned long damon_pa_migrate(struct damon_region *r, struct damos *s)
 put_folio:
 		folio_put(folio);
 	}
-	applied = damon_pa_migrate_pages(&folio_list, s->target_nid);
+	applied = damon_pa_migrate_pages(&folio_list, s->action, s->target_nid);
 	cond_resched();
 	return applied * PAGE_SIZE;
 }
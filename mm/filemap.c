@@ -137,8 +137,10 @@ static void page_cache_delete(struct address_space *mapping,
 
 	VM_BUG_ON_FOLIO(!folio_test_locked(folio), folio);
 
+	write_seqcount_begin(&mapping->i_pages_delete_seqcnt);
 	xas_store(&xas, shadow);
 	xas_init_marks(&xas);
+	write_seqcount_end(&mapping->i_pages_delete_seqcnt);
 
 	folio->mapping = NULL;
 	/* Leave page->index set: truncation lookup relies upon it */
@@ -283,6 +285,7 @@ static void page_cache_delete_batch(struct address_space *mapping,
 	struct folio *folio;
 
 	mapping_set_update(&xas, mapping);
+	write_seqcount_begin(&mapping->i_pages_delete_seqcnt);
 	xas_for_each(&xas, folio, ULONG_MAX) {
 		if (i >= folio_batch_count(fbatch))
 			break;
@@ -312,6 +315,7 @@ static void page_cache_delete_batch(struct address_space *mapping,
 		xas_store(&xas, NULL);
 		total_pages += folio_nr_pages(folio);
 	}
+	write_seqcount_end(&mapping->i_pages_delete_seqcnt);
 	mapping->nrpages -= total_pages;
 }
 
@@ -440,6 +444,24 @@ int filemap_fdatawrite_range(struct address_space *mapping, loff_t start,
 }
 EXPORT_SYMBOL(filemap_fdatawrite_range);
 
+/**
+ * filemap_fdatawrite_range_kick - start writeback on a range
+ * @mapping:	target address_space
+ * @start:	index to start writeback on
+ * @end:	last (inclusive) index for writeback
+ *
+ * This is a non-integrity writeback helper, to start writing back folios
+ * for the indicated range.
+ *
+ * Return: %0 on success, negative error code otherwise.
+ */
+int filemap_fdatawrite_range_kick(struct address_space *mapping, loff_t start,
+				  loff_t end)
+{
+	return __filemap_fdatawrite_range(mapping, start, end, WB_SYNC_NONE);
+}
+EXPORT_SYMBOL_GPL(filemap_fdatawrite_range_kick);
+
 /**
  * filemap_flush - mostly a non-blocking flush
  * @mapping:	target address_space
@@ -819,7 +841,9 @@ void replace_page_cache_folio(struct folio *old, struct folio *new)
 	mem_cgroup_replace_folio(old, new);
 
 	xas_lock_irq(&xas);
+	write_seqcount_begin(&mapping->i_pages_delete_seqcnt);
 	xas_store(&xas, new);
+	write_seqcount_end(&mapping->i_pages_delete_seqcnt);
 
 	old->mapping = NULL;
 	/* hugetlb pages do not participate in page cache accounting. */
@@ -1590,6 +1614,24 @@ int folio_wait_private_2_killable(struct folio *folio)
 }
 EXPORT_SYMBOL(folio_wait_private_2_killable);
 
+/*
+ * If the folio was marked as dropbehind, it should be removed from the page
+ * cache now that writeback has completed.  Invalidation needs to sleep, so
+ * it can only be done when writeback is completed from task context.  In
+ * other contexts, or if the folio lock is contended, leave the folio to be
+ * reclaimed first by rotating it to the tail of the inactive list.
+ */
+static void folio_end_dropbehind_write(struct folio *folio)
+{
+	if (in_task() && folio_trylock(folio)) {
+		if (folio->mapping)
+			folio_unmap_invalidate(folio->mapping, folio);
+		folio_unlock(folio);
+		return;
+	}
+	folio_rotate_reclaimable(folio);
+}
+
 /**
  * folio_end_writeback - End writeback against a folio.
  * @folio: The folio.
@@ -1600,6 +1642,8 @@ EXPORT_SYMBOL(folio_wait_private_2_killable);
  */
 void folio_end_writeback(struct folio *folio)
 {
+	bool dropbehind = false;
+
 	VM_BUG_ON_FOLIO(!folio_test_writeback(folio), folio);
 
 	/*
@@ -1621,9 +1665,14 @@ void folio_end_writeback(struct folio *folio)
 	 * reused before the folio_wake_bit().
 	 */
 	folio_get(folio);
+	if (!folio_test_dirty(folio))
+		dropbehind = folio_test_clear_dropbehind(folio);
 	if (__folio_end_writeback(folio))
 		folio_wake_bit(folio, PG_writeback);
 	acct_reclaim_writeback(folio);
+
+	if (dropbehind)
+		folio_end_dropbehind_write(folio);
 	folio_put(folio);
 }
 EXPORT_SYMBOL(folio_end_writeback);
@@ -1907,6 +1956,10 @@ struct folio *__filemap_get_folio(struct address_space *mapping, pgoff_t index,
 			folio_clear_idle(folio);
 	}
 
+	/* A cached access keeps an uncached folio in the page cache. */
+	if (!(fgp_flags & FGP_DONTCACHE) && folio_test_dropbehind(folio))
+		folio_clear_dropbehind(folio);
+
 	if (fgp_flags & FGP_STABLE)
 		folio_wait_stable(folio);
 no_page:
@@ -1946,6 +1999,8 @@ struct folio *__filemap_get_folio(struct address_space *mapping, pgoff_t index,
 			/* Init accessed so avoid atomic mark_page_accessed later */
 			if (fgp_flags & FGP_ACCESSED)
 				__folio_set_referenced(folio);
+			if (fgp_flags & FGP_DONTCACHE)
+				__folio_set_dropbehind(folio);
 
 			err = filemap_add_folio(mapping, folio, index, gfp);
 			if (!err)
@@ -2450,10 +2505,12 @@ static int filemap_update_page(struct kiocb *iocb,
 	return error;
 }
 
-static int filemap_create_folio(struct file *file,
-		struct address_space *mapping, loff_t pos,
+static int filemap_create_folio(struct kiocb *iocb,
 		struct folio_batch *fbatch)
 {
+	struct file *file = iocb->ki_filp;
+	struct address_space *mapping = file->f_mapping;
+	loff_t pos = iocb->ki_pos;
 	struct folio *folio;
 	int error;
 	unsigned int min_order = mapping_min_folio_order(mapping);
@@ -2462,6 +2519,8 @@ static int filemap_create_folio(struct file *file,
 	folio = filemap_alloc_folio(mapping_gfp_mask(mapping), min_order);
 	if (!folio)
 		return -ENOMEM;
+	if (iocb->ki_flags & IOCB_DONTCACHE)
+		__folio_set_dropbehind(folio);
 
 	/*
 	 * Protect against truncate / hole punch. Grabbing invalidate_lock
@@ -2506,6 +2565,8 @@ static int filemap_readahead(struct kiocb *iocb, struct file *file,
 
 	if (iocb->ki_flags & IOCB_NOIO)
 		return -EAGAIN;
+	if (iocb->ki_flags & IOCB_DONTCACHE)
+		ractl.dropbehind = true;
 	page_cache_async_ra(&ractl, folio, last_index - folio->index);
 	return 0;
 }
@@ -2530,12 +2591,15 @@ static int filemap_get_pages(struct kiocb *iocb, size_t count,
 
 	filemap_get_read_batch(mapping, index, last_index - 1, fbatch);
 	if (!folio_batch_count(fbatch)) {
+		DEFINE_READAHEAD(ractl, filp, ra, mapping, index);
+
 		if (iocb->ki_flags & IOCB_NOIO)
 			return -EAGAIN;
 		if (iocb->ki_flags & IOCB_NOWAIT)
 			flags = memalloc_noio_save();
-		page_cache_sync_readahead(mapping, ra, filp, index,
-				last_index - index);
+		if (iocb->ki_flags & IOCB_DONTCACHE)
+			ractl.dropbehind = true;
+		page_cache_sync_ra(&ractl, last_index - index);
 		if (iocb->ki_flags & IOCB_NOWAIT)
 			memalloc_noio_restore(flags);
 		filemap_get_read_batch(mapping, index, last_index - 1, fbatch);
@@ -2543,7 +2607,7 @@ static int filemap_get_pages(struct kiocb *iocb, size_t count,
 	if (!folio_batch_count(fbatch)) {
 		if (iocb->ki_flags & (IOCB_NOWAIT | IOCB_WAITQ))
 			return -EAGAIN;
-		err = filemap_create_folio(filp, mapping, iocb->ki_pos, fbatch);
+		err = filemap_create_folio(iocb, fbatch);
 		if (err == AOP_TRUNCATED_PAGE)
 			goto retry;
 		return err;
@@ -2584,6 +2648,114 @@ static inline bool pos_same_folio(loff_t pos1, loff_t pos2, struct folio *folio)
 	return (pos1 >> shift == pos2 >> shift);
 }
 
+/*
+ * Uncached reads remove the folios they brought into the page cache once all
+ * of the folio has been consumed.  A cached read of such a folio keeps it in
+ * the page cache instead.
+ */
+static void filemap_end_dropbehind_read(struct kiocb *iocb,
+		struct folio *folio, loff_t isize)
+{
+	if (!folio_test_dropbehind(folio))
+		return;
+	if (!(iocb->ki_flags & IOCB_DONTCACHE)) {
+		folio_clear_dropbehind(folio);
+		return;
+	}
+	if (iocb->ki_pos < folio_pos(folio) + folio_size(folio) &&
+	    iocb->ki_pos < isize)
+		return;
+	if (folio_test_writeback(folio) || folio_test_dirty(folio))
+		return;
+	if (folio_trylock(folio)) {
+		if (folio_test_clear_dropbehind(folio) && folio->mapping)
+			folio_unmap_invalidate(folio->mapping, folio);
+		folio_unlock(folio);
+	}
+}
+
+/*
+ * Largest read served by filemap_read_fast().  The data is bounced through a
+ * buffer of this size on the stack.
+ */
+#define FILEMAP_FAST_READ_MAX	512
+
+/*
+ * Marking a folio accessed needs a stable folio.  Only take the fast path if
+ * filemap_read() would not have to do anything here, i.e. if the folio was
+ * already accessed by the previous read or is already active and referenced.
+ */
+static bool filemap_fast_read_accessed(struct folio *folio, loff_t pos,
+		loff_t last_pos)
+{
+	if (pos_same_folio(pos, last_pos - 1, folio))
+		return true;
+	return !lru_gen_enabled() && folio_test_referenced(folio) &&
+		folio_test_active(folio) && !folio_test_idle(folio);
+}
+
+/*
+ * Serve a short read from a single uptodate folio without taking a reference
+ * on it.  A page cache folio cannot be freed before it has been removed from
+ * the mapping, which bumps i_pages_delete_seqcnt, so copying the data into a
+ * bounce buffer under RCU and checking the sequence count afterwards tells us
+ * whether the copy is valid.  The copy uses copy_from_kernel_nofault() as the
+ * folio may have been freed and reused by the time we look at it.  The data
+ * is copied to user space after leaving the RCU read-side critical section.
+ *
+ * Returns the number of bytes read, or 0 if the read has to take the slow
+ * path.
+ */
+static noinline size_t filemap_read_fast(struct kiocb *iocb,
+		struct iov_iter *iter, loff_t last_pos)
+{
+	struct address_space *mapping = iocb->ki_filp->f_mapping;
+	XA_STATE(xas, &mapping->i_pages, iocb->ki_pos >> PAGE_SHIFT);
+	size_t count = iov_iter_count(iter);
+	char buffer[FILEMAP_FAST_READ_MAX];
+	struct folio *folio;
+	unsigned int seq;
+	size_t offset;
+	loff_t isize;
+
+	if (count > sizeof(buffer) || mapping_writably_mapped(mapping))
+		return 0;
+	if (iocb->ki_flags & IOCB_DONTCACHE)
+		return 0;
+
+	rcu_read_lock();
+	seq = read_seqcount_begin(&mapping->i_pages_delete_seqcnt);
+	folio = xas_load(&xas);
+	if (!folio || xa_is_value(folio) || xa_is_internal(folio))
+		goto slow;
+	if (!folio_test_uptodate(folio) || folio_test_readahead(folio) ||
+	    folio_test_highmem(folio) || folio_test_hwpoison(folio))
+		goto slow;
+	if (folio_test_large(folio) && folio_test_has_hwpoisoned(folio))
+		goto slow;
+	if (!filemap_fast_read_accessed(folio, iocb->ki_pos, last_pos))
+		goto slow;
+
+	isize = i_size_read(mapping->host);
+	if (iocb->ki_pos >= isize)
+		goto slow;
+	count = min_t(loff_t, count, isize - iocb->ki_pos);
+	offset = offset_in_folio(folio, iocb->ki_pos);
+	count = min(count, folio_size(folio) - offset);
+
+	if (copy_from_kernel_nofault(buffer, folio_address(folio) + offset,
+				     count))
+		goto slow;
+	if (read_seqcount_retry(&mapping->i_pages_delete_seqcnt, seq))
+		goto slow;
+	rcu_read_unlock();
+
+	return copy_to_iter(buffer, count, iter);
+slow:
+	rcu_read_unlock();
+	return 0;
+}
+
 /**
  * filemap_read - Read data from the page cache.
  * @iocb: The iocb to read.
@@ -2620,6 +2792,18 @@ ssize_t filemap_read(struct kiocb *iocb, struct iov_iter *iter,
 	iov_iter_truncate(iter, inode->i_sb->s_maxbytes - iocb->ki_pos);
 	folio_batch_init(&fbatch);
 
+	if (!already_read) {
+		size_t copied = filemap_read_fast(iocb, iter, last_pos);
+
+		if (copied) {
+			already_read = copied;
+			iocb->ki_pos += copied;
+			last_pos = iocb->ki_pos;
+			if (!iov_iter_count(iter))
+				goto out;
+		}
+	}
+
 	do {
 		cond_resched();
 
@@ -2697,11 +2881,16 @@ ssize_t filemap_read(struct kiocb *iocb, struct iov_iter *iter,
 			}
 		}
 put_folios:
-		for (i = 0; i < folio_batch_count(&fbatch); i++)
-			folio_put(fbatch.folios[i]);
+		for (i = 0; i < folio_batch_count(&fbatch); i++) {
+			struct folio *folio = fbatch.folios[i];
+
+			filemap_end_dropbehind_read(iocb, folio, isize);
+			folio_put(folio);
+		}
 		folio_batch_init(&fbatch);
 	} while (iov_iter_count(iter) && iocb->ki_pos < isize && !error);
 
+out:
 	file_accessed(filp);
 	ra->prev_pos = last_pos;
 	return already_read ? already_read : error;
@@ -4004,6 +4193,25 @@ generic_file_direct_write(struct kiocb *iocb, struct iov_iter *from)
 }
 EXPORT_SYMBOL(generic_file_direct_write);
 
+/*
+ * Whether an uncached write at @pos finds a folio that is cached for someone
+ * else.  A folio still marked dropbehind was brought in uncached, typically by
+ * an earlier part of the same write, and ->write_begin() implementations that
+ * look it up without FGP_DONTCACHE clear the mark, so it must be set again.
+ */
+static bool filemap_write_cached(struct address_space *mapping, loff_t pos)
+{
+	struct folio *folio;
+	bool cached;
+
+	folio = filemap_get_entry(mapping, pos >> PAGE_SHIFT);
+	if (!folio || xa_is_value(folio))
+		return false;
+	cached = !folio_test_dropbehind(folio);
+	folio_put(folio);
+	return cached;
+}
+
 ssize_t generic_perform_write(struct kiocb *iocb, struct iov_iter *i)
 {
 	struct file *file = iocb->ki_filp;
@@ -4020,6 +4228,7 @@ ssize_t generic_perform_write(struct kiocb *iocb, struct iov_iter *i)
 		size_t bytes;		/* Bytes to write to folio */
 		size_t copied;		/* Bytes copied from user */
 		void *fsdata = NULL;
+		bool cached;
 
 		bytes = iov_iter_count(i);
 retry:
@@ -4043,11 +4252,22 @@ ssize_t generic_perform_write(struct kiocb *iocb, struct iov_iter *i)
 			break;
 		}
 
+		/*
+		 * ->write_begin() has no way of creating the folio as
+		 * uncached, so note whether it is already cached and only
+		 * mark folios that are not cached for anyone else below.
+		 */
+		cached = (iocb->ki_flags & IOCB_DONTCACHE) &&
+			 filemap_write_cached(mapping, pos);
+
 		status = a_ops->write_begin(file, mapping, pos, bytes,
 						&folio, &fsdata);
 		if (unlikely(status < 0))
 			break;
 
+		if ((iocb->ki_flags & IOCB_DONTCACHE) && !cached)
+			folio_set_dropbehind(folio);
+
 		offset = offset_in_folio(folio, pos);
 		if (bytes > folio_size(folio) - offset)
 			bytes = folio_size(folio) - offset;
@@ -438,6 +438,21 @@ static ssize_t use_zero_page_store(struct kobject *kobj,
 }
 static struct kobj_attribute use_zero_page_attr = __ATTR_RW(use_zero_page);
 
+static ssize_t adaptive_anon_order_show(struct kobject *kobj,
+					struct kobj_attribute *attr, char *buf)
+{
+	return single_hugepage_flag_show(kobj, attr, buf,
+				TRANSPARENT_HUGEPAGE_ADAPTIVE_ANON_ORDER_FLAG);
+}
+static ssize_t adaptive_anon_order_store(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	return single_hugepage_flag_store(kobj, attr, buf, count,
+				TRANSPARENT_HUGEPAGE_ADAPTIVE_ANON_ORDER_FLAG);
+}
+static struct kobj_attribute adaptive_anon_order_attr =
+	__ATTR_RW(adaptive_anon_order);
+
 static ssize_t hpage_pmd_size_show(struct kobject *kobj,
 				   struct kobj_attribute *attr, char *buf)
 {
@@ -471,6 +486,7 @@ static struct attribute *hugepage_attr[] = {
 	&enabled_attr.attr,
 	&defrag_attr.attr,
 	&use_zero_page_attr.attr,
+	&adaptive_anon_order_attr.attr,
 	&hpage_pmd_size_attr.attr,
 #ifdef CONFIG_SHMEM
 	&shmem_enabled_attr.attr,
@@ -1218,8 +1234,15 @@ static vm_fault_t __do_huge_pmd_anonymous_page(struct vm_fault *vmf)
 	vm_fault_t ret = 0;
 
 	folio = vma_alloc_anon_folio_pmd(vma, vmf->address);
-	if (unlikely(!folio))
+	if (unlikely(!folio)) {
+		/*
+		 * Map base pages now and let khugepaged collapse the range
+		 * once a huge page can be had, rather than leaving it to the
+		 * linear scan.
+		 */
+		khugepaged_defer_fault(vma, haddr);
 		return VM_FAULT_FALLBACK;
+	}
 
 	pgtable = pte_alloc_one(vma->vm_mm);
 	if (unlikely(!pgtable)) {
@@ -2183,7 +2183,9 @@ static int collapse_file(struct mm_struct *mm, unsigned long addr,
 
 	/* Join all the small entries into a single multi-index entry. */
 	xas_set_order(&xas, start, HPAGE_PMD_ORDER);
+	write_seqcount_begin(&mapping->i_pages_delete_seqcnt);
 	xas_store(&xas, new_folio);
+	write_seqcount_end(&mapping->i_pages_delete_seqcnt);
 	WARN_ON_ONCE(xas_error(&xas));
 	xas_unlock_irq(&xas);
 
@@ -2348,6 +2350,69 @@ static int hpage_collapse_scan_file(struct mm_struct *mm, unsigned long addr,
 }
 #endif
 
+/**
+ * khugepaged_defer_fault - queue a PMD range for collapse after THP fallback
+ * @vma: the anonymous VMA the fault happened in
+ * @haddr: PMD aligned fault address
+ *
+ * Called when a THP fault could not get a huge page and the range got mapped
+ * with base pages instead. The range is remembered in the mm, overwriting the
+ * oldest one if all slots are in use, and the mm is moved to the front of the
+ * khugepaged scan list, so that the range is collapsed on the next khugepaged
+ * pass instead of whenever the linear scan gets to it.
+ *
+ * This runs on the fault path, so only the first deferred fault since
+ * khugepaged last looked at the mm takes khugepaged_mm_lock.  Racing faults
+ * may lose or duplicate an entry, which only costs a collapse attempt.
+ */
+void khugepaged_defer_fault(struct vm_area_struct *vma, unsigned long haddr)
+{
+	struct mm_struct *mm = vma->vm_mm;
+	struct khugepaged_mm_slot *mm_slot;
+	struct mm_slot *slot;
+	unsigned int i;
+
+	if (!test_bit(MMF_VM_HUGEPAGE, &mm->flags))
+		return;
+
+	for (i = 0; i < KHUGEPAGED_MAX_DEFERRED; i++)
+		if (READ_ONCE(mm->khugepaged_deferred[i]) == haddr)
+			return;
+
+	i = atomic_fetch_inc_relaxed(&mm->khugepaged_deferred_next);
+	WRITE_ONCE(mm->khugepaged_deferred[i % KHUGEPAGED_MAX_DEFERRED], haddr);
+
+	if (atomic_xchg(&mm->khugepaged_deferred_queued, 1))
+		return;
+
+	spin_lock(&khugepaged_mm_lock);
+	slot = mm_slot_lookup(mm_slots_hash, mm);
+	mm_slot = mm_slot_entry(slot, struct khugepaged_mm_slot, slot);
+	/* Scan this mm right after the one khugepaged is working on */
+	if (mm_slot && khugepaged_scan.mm_slot != mm_slot) {
+		if (khugepaged_scan.mm_slot)
+			list_move(&slot->mm_node,
+				  &khugepaged_scan.mm_slot->slot.mm_node);
+		else
+			list_move(&slot->mm_node, &khugepaged_scan.mm_head);
+	}
+	spin_unlock(&khugepaged_mm_lock);
+}
+
+static unsigned long khugepaged_next_deferred(struct mm_struct *mm)
+{
+	unsigned long addr;
+	unsigned int i;
+
+	for (i = 0; i < KHUGEPAGED_MAX_DEFERRED; i++) {
+		addr = xchg(&mm->khugepaged_deferred[i], 0);
+		if (addr)
+			return addr;
+	}
+
+	return 0;
+}
+
 static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 					    struct collapse_control *cc)
 	__releases(&khugepaged_mm_lock)
@@ -2358,6 +2423,7 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 	struct mm_slot *slot;
 	struct mm_struct *mm;
 	struct vm_area_struct *vma;
+	unsigned long addr;
 	int progress = 0;
 
 	VM_BUG_ON(!pages);
@@ -2389,6 +2455,38 @@ static unsigned int khugepaged_scan_mm_slot(unsigned int pages, int *result,
 	if (unlikely(hpage_collapse_test_exit_or_disable(mm)))
 		goto breakouterloop;
 
+	/*
+	 * Ranges whose THP fault fell back to base pages were just touched,
+	 * collapse them before resuming the linear scan.  Clear the queued
+	 * state first so that faults racing with us requeue the mm.
+	 */
+	atomic_xchg(&mm->khugepaged_deferred_queued, 0);
+	while ((addr = khugepaged_next_deferred(mm))) {
+		bool mmap_locked = true;
+
+		cond_resched();
+		progress++;
+		vma = vma_lookup(mm, addr);
+		if (!vma || !vma_is_anonymous(vma) ||
+		    addr + HPAGE_PMD_SIZE > vma->vm_end ||
+		    !thp_vma_allowable_order(vma, vma->vm_flags,
+					     TVA_ENFORCE_SYSFS, PMD_ORDER))
+			continue;
+
+		*result = hpage_collapse_scan_pmd(mm, vma, addr, &mmap_locked,
+						  cc);
+		if (*result == SCAN_SUCCEED)
+			++khugepaged_pages_collapsed;
+
+		progress += HPAGE_PMD_NR;
+		if (!mmap_locked)
+			goto breakouterloop_mmap_lock;
+		if (progress >= pages)
+			goto breakouterloop;
+		if (unlikely(hpage_collapse_test_exit_or_disable(mm)))
+			goto breakouterloop;
+	}
+
 	vma_iter_init(&vmi, mm, khugepaged_scan.address);
 	for_each_vma(vmi, vma) {
 		unsigned long hstart, hend;
@@ -300,6 +300,15 @@ atomic_long_t ksm_zero_pages = ATOMIC_LONG_INIT(0);
 /* The number of pages that have been skipped due to "smart scanning" */
 static unsigned long ksm_pages_skipped;
 
+/*
+ * Filter of the checksums of all stable tree pages, indexed by the low
+ * bits of the checksum. A clear bit means no stable page has that content,
+ * so the stable tree search can be skipped. Bits are never cleared while
+ * stable nodes exist, so the filter has false positives only.
+ */
+static unsigned long *ksm_stable_filter __read_mostly;
+static unsigned int ksm_stable_filter_mask __read_mostly;
+
 /* Don't scan more than max pages per batch. */
 static unsigned long ksm_advisor_max_pages_to_scan = 30000;
 
@@ -1069,6 +1078,40 @@ static inline void folio_set_stable_node(struct folio *folio,
 	folio->mapping = (void *)((unsigned long)stable_node | PAGE_MAPPING_KSM);
 }
 
+static void stable_filter_add(u32 checksum)
+{
+	if (ksm_stable_filter)
+		set_bit(checksum & ksm_stable_filter_mask, ksm_stable_filter);
+}
+
+static bool stable_filter_may_contain(u32 checksum)
+{
+	if (!ksm_stable_filter)
+		return true;
+
+	return test_bit(checksum & ksm_stable_filter_mask, ksm_stable_filter);
+}
+
+static void stable_filter_reset(void)
+{
+	if (ksm_stable_filter)
+		bitmap_zero(ksm_stable_filter, ksm_stable_filter_mask + 1);
+}
+
+static void __init stable_filter_init(void)
+{
+	unsigned long nr_bits;
+
+	/* About one bit per four pages of memory, as stable pages are rarer. */
+	nr_bits = roundup_pow_of_two(max(totalram_pages() / 4, 1UL << 16));
+	nr_bits = min(nr_bits, 1UL << 31);
+
+	ksm_stable_filter = kvzalloc(BITS_TO_LONGS(nr_bits) * sizeof(long),
+				     GFP_KERNEL);
+	if (ksm_stable_filter)
+		ksm_stable_filter_mask = nr_bits - 1;
+}
+
 #ifdef CONFIG_SYSFS
 /*
  * Only called through the sysfs control interface:
@@ -1159,6 +1202,8 @@ static int remove_all_stable_nodes(void)
 			err = -EBUSY;
 		cond_resched();
 	}
+	if (!err)
+		stable_filter_reset();
 	return err;
 }
 
@@ -2221,6 +2266,7 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 	unsigned int checksum;
 	int err;
 	bool max_page_sharing_bypass = false;
+	bool search_stable = true;
 
 	stable_node = page_stable_node(page);
 	if (stable_node) {
@@ -2252,16 +2298,26 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 		checksum = calc_checksum(page);
 		if (rmap_item->oldchecksum != checksum) {
 			rmap_item->oldchecksum = checksum;
+			/*
+			 * Pages whose content keeps changing are the least
+			 * likely to ever merge: age them twice as fast so that
+			 * smart scanning backs off from them sooner than from
+			 * stable pages still waiting for a partner.
+			 */
+			if (ksm_smart_scan && rmap_item->age != U8_MAX)
+				rmap_item->age++;
 			return;
 		}
 
 		if (!try_to_merge_with_zero_page(rmap_item, page))
 			return;
+
+		search_stable = stable_filter_may_contain(checksum);
 	}
 
 	/* Start by searching for the folio in the stable tree */
-	kfolio = stable_tree_search(page);
-	if (&kfolio->page == page && rmap_item->head == stable_node) {
+	kfolio = search_stable ? stable_tree_search(page) : NULL;
+	if (kfolio && &kfolio->page == page && rmap_item->head == stable_node) {
 		folio_put(kfolio);
 		return;
 	}
@@ -2315,6 +2371,13 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 			folio_lock(kfolio);
 			stable_node = stable_tree_insert(kfolio);
 			if (stable_node) {
+				/*
+				 * Hash the merged page, which is write
+				 * protected now, rather than reusing the
+				 * checksum taken before the merge: the page
+				 * may have changed in between.
+				 */
+				stable_filter_add(calc_checksum(&kfolio->page));
 				stable_tree_append(tree_rmap_item, stable_node,
 						   false);
 				stable_tree_append(rmap_item, stable_node,
@@ -3808,6 +3871,8 @@ static int __init ksm_init(void)
 	/* Default to false for backwards compatibility */
 	ksm_use_zero_pages = false;
 
+	stable_filter_init();
+
 	err = ksm_slab_init();
 	if (err)
 		goto out;
@@ -794,8 +794,14 @@ static const struct mm_walk_ops madvise_free_walk_ops = {
 	.walk_lock		= PGWALK_RDLOCK,
 };
 
+static const struct mm_walk_ops madvise_free_vma_walk_ops = {
+	.pmd_entry		= madvise_free_pte_range,
+	.walk_lock		= PGWALK_VMA_RDLOCK_VERIFY,
+};
+
 static int madvise_free_single_vma(struct vm_area_struct *vma,
-			unsigned long start_addr, unsigned long end_addr)
+			unsigned long start_addr, unsigned long end_addr,
+			bool vma_locked)
 {
 	struct mm_struct *mm = vma->vm_mm;
 	struct mmu_notifier_range range;
@@ -820,8 +826,9 @@ static int madvise_free_single_vma(struct vm_area_struct *vma,
 
 	mmu_notifier_invalidate_range_start(&range);
 	tlb_start_vma(&tlb, vma);
-	walk_page_range(vma->vm_mm, range.start, range.end,
-			&madvise_free_walk_ops, &tlb);
+	walk_page_range_vma(vma, range.start, range.end,
+			    vma_locked ? &madvise_free_vma_walk_ops :
+					 &madvise_free_walk_ops, &tlb);
 	tlb_end_vma(&tlb, vma);
 	mmu_notifier_invalidate_range_end(&range);
 	tlb_finish_mmu(&tlb);
@@ -934,11 +941,81 @@ static long madvise_dontneed_free(struct vm_area_struct *vma,
 	if (behavior == MADV_DONTNEED || behavior == MADV_DONTNEED_LOCKED)
 		return madvise_dontneed_single_vma(vma, start, end);
 	else if (behavior == MADV_FREE)
-		return madvise_free_single_vma(vma, start, end);
+		return madvise_free_single_vma(vma, start, end, false);
 	else
 		return -EINVAL;
 }
 
+#ifdef CONFIG_PER_VMA_LOCK
+/*
+ * Try to handle MADV_DONTNEED and MADV_FREE on a range that lies within a
+ * single anonymous VMA while holding only the per-VMA read lock, so that
+ * allocators returning memory to the kernel do not contend on mmap_lock
+ * with concurrent page faults and mmap()/munmap() in other threads.
+ *
+ * Returns -EAGAIN if the request can not be handled this way, in which case
+ * the caller must fall back to the mmap_lock path.
+ */
+static int madvise_dontneed_free_vma_locked(struct mm_struct *mm,
+					    unsigned long start,
+					    unsigned long end, int behavior)
+{
+	struct vm_area_struct *vma;
+	int error = -EAGAIN;
+
+	switch (behavior) {
+	case MADV_DONTNEED:
+	case MADV_DONTNEED_LOCKED:
+	case MADV_FREE:
+		break;
+	default:
+		return -EAGAIN;
+	}
+
+	/* lock_vma_under_rcu() only works on the caller's own mm. */
+	if (mm != current->mm)
+		return -EAGAIN;
+
+	vma = lock_vma_under_rcu(mm, start);
+	if (!vma)
+		return -EAGAIN;
+
+	/*
+	 * Anything that may need mmap_lock - ranges spanning several VMAs,
+	 * file or hugetlb mappings, and userfaultfd which may drop and
+	 * re-take it in userfaultfd_remove() - goes the slow way.
+	 */
+	if (end > vma->vm_end || !vma_is_anonymous(vma) ||
+	    userfaultfd_armed(vma))
+		goto out;
+
+	if (unlikely(!can_modify_vma_madv(vma, behavior))) {
+		error = -EPERM;
+		goto out;
+	}
+	if (!madvise_dontneed_free_valid_vma(vma, start, &end, behavior)) {
+		error = -EINVAL;
+		goto out;
+	}
+
+	if (behavior == MADV_FREE)
+		error = madvise_free_single_vma(vma, start, end, true);
+	else
+		error = madvise_dontneed_single_vma(vma, start, end);
+out:
+	vma_end_read(vma);
+	return error;
+}
+#else
+static inline int madvise_dontneed_free_vma_locked(struct mm_struct *mm,
+						   unsigned long start,
+						   unsigned long end,
+						   int behavior)
+{
+	return -EAGAIN;
+}
+#endif /* CONFIG_PER_VMA_LOCK */
+
 static long madvise_populate(struct mm_struct *mm, unsigned long start,
 		unsigned long end, int behavior)
 {
@@ -1663,6 +1740,12 @@ int do_madvise(struct mm_struct *mm, unsigned long start, size_t len_in, int beh
 		return madvise_inject_error(behavior, start, start + len_in);
 #endif
 
+	error = madvise_dontneed_free_vma_locked(mm, untagged_addr(start),
+						 untagged_addr(start) + len,
+						 behavior);
+	if (error != -EAGAIN)
+		return error;
+
 	write = madvise_need_mmap_write(behavior);
 	if (write) {
 		if (mmap_write_lock_killable(mm))
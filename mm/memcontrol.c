@@ -618,10 +618,12 @@ static void __mem_cgroup_flush_stats(struct mem_cgroup *memcg, bool force)
  * mem_cgroup_flush_stats - flush the stats of a memory cgroup subtree
  * @memcg: root of the subtree to flush
  *
- * Flushing is serialized by the underlying global rstat lock. There is also a
- * minimum amount of work to be done even if there are no stat updates to flush.
- * Hence, we only flush the stats if the updates delta exceeds a threshold. This
- * avoids unnecessary work and contention on the underlying lock.
+ * Flushing is serialized by the underlying global rstat lock, although
+ * cgroup_rstat_flush() skips the lock entirely when nothing in @memcg's
+ * subtree is pending. There is also a minimum amount of work to be done even
+ * if there are no stat updates to flush. Hence, we only flush the stats if the
+ * updates delta exceeds a threshold. This avoids unnecessary work and
+ * contention on the underlying lock.
  */
 void mem_cgroup_flush_stats(struct mem_cgroup *memcg)
 {
@@ -1448,7 +1450,8 @@ unsigned long memcg_page_state_local_output(struct mem_cgroup *memcg, int item)
 		memcg_page_state_output_unit(item);
 }
 
-static void memcg_stat_format(struct mem_cgroup *memcg, struct seq_buf *s)
+static void memcg_stat_format(struct mem_cgroup *memcg, struct seq_buf *s,
+			      bool approx)
 {
 	int i;
 
@@ -1461,8 +1464,14 @@ static void memcg_stat_format(struct mem_cgroup *memcg, struct seq_buf *s)
 	 * 2) reflecting userspace activity -> reflecting kernel heuristics
 	 *
 	 * Current memory state:
+	 *
+	 * Approximate readers don't flush synchronously and instead rely on
+	 * the periodic flusher, so the numbers may lag by up to 2*FLUSH_TIME.
 	 */
-	mem_cgroup_flush_stats(memcg);
+	if (approx)
+		mem_cgroup_flush_stats_ratelimited(memcg);
+	else
+		mem_cgroup_flush_stats(memcg);
 
 	for (i = 0; i < ARRAY_SIZE(memory_stats); i++) {
 		u64 size;
@@ -1504,10 +1513,11 @@ static void memcg_stat_format(struct mem_cgroup *memcg, struct seq_buf *s)
 	}
 }
 
-static void memory_stat_format(struct mem_cgroup *memcg, struct seq_buf *s)
+static void memory_stat_format(struct mem_cgroup *memcg, struct seq_buf *s,
+			       bool approx)
 {
 	if (cgroup_subsys_on_dfl(memory_cgrp_subsys))
-		memcg_stat_format(memcg, s);
+		memcg_stat_format(memcg, s, approx);
 	else
 		memcg1_stat_format(memcg, s);
 	if (seq_buf_has_overflowed(s))
@@ -1574,7 +1584,7 @@ void mem_cgroup_print_oom_meminfo(struct mem_cgroup *memcg)
 	pr_cont_cgroup_path(memcg->css.cgroup);
 	pr_cont(":");
 	seq_buf_init(&s, buf, SEQ_BUF_SIZE);
-	memory_stat_format(memcg, &s);
+	memory_stat_format(memcg, &s, false);
 	seq_buf_do_printk(&s, KERN_INFO);
 }
 
@@ -1721,10 +1731,26 @@ void mem_cgroup_print_oom_group(struct mem_cgroup *memcg)
 	pr_cont(" are going to be killed due to memory.oom.group set\n");
 }
 
+/*
+ * Number of memcgs whose charges are cached per cpu. Hosts with many active
+ * cgroups would otherwise keep evicting each other's stock and fall through
+ * to the shared page_counter hierarchy on nearly every charge.
+ */
+#define NR_MEMCG_STOCK 4
+
+/*
+ * Upper bound on a single stock slot. Slots normally hold no more than
+ * MEMCG_CHARGE_BATCH pages, but a slot refilled for a large folio charge may
+ * hold up to this much so that the next few folios of that size are served
+ * locally too.
+ */
+#define MEMCG_STOCK_MAX (4 * MEMCG_CHARGE_BATCH)
+
 struct memcg_stock_pcp {
 	local_lock_t stock_lock;
-	struct mem_cgroup *cached; /* this never be root cgroup */
-	unsigned int nr_pages;
+	/* these never be root cgroup */
+	struct mem_cgroup *cached[NR_MEMCG_STOCK];
+	unsigned int nr_pages[NR_MEMCG_STOCK];
 
 	struct obj_cgroup *cached_objcg;
 	struct pglist_data *cached_pgdat;
@@ -1750,9 +1776,9 @@ static bool obj_stock_flush_required(struct memcg_stock_pcp *stock,
  * @memcg: memcg to consume from.
  * @nr_pages: how many pages to charge.
  *
- * The charges will only happen if @memcg matches the current cpu's memcg
- * stock, and at least @nr_pages are available in that stock.  Failure to
- * service an allocation will refill the stock.
+ * The charges will only happen if @memcg matches one of the current cpu's
+ * memcg stocks, and at least @nr_pages are available in that stock.  Failure
+ * to service an allocation will refill the stock.
  *
  * returns true if successful, false otherwise.
  */
@@ -1762,17 +1788,23 @@ static bool consume_stock(struct mem_cgroup *memcg, unsigned int nr_pages)
 	unsigned int stock_pages;
 	unsigned long flags;
 	bool ret = false;
+	int i;
 
-	if (nr_pages > MEMCG_CHARGE_BATCH)
+	if (nr_pages > MEMCG_STOCK_MAX)
 		return ret;
 
 	local_lock_irqsave(&memcg_stock.stock_lock, flags);
 
 	stock = this_cpu_ptr(&memcg_stock);
-	stock_pages = READ_ONCE(stock->nr_pages);
-	if (memcg == READ_ONCE(stock->cached) && stock_pages >= nr_pages) {
-		WRITE_ONCE(stock->nr_pages, stock_pages - nr_pages);
-		ret = true;
+	for (i = 0; i < NR_MEMCG_STOCK; i++) {
+		if (memcg != READ_ONCE(stock->cached[i]))
+			continue;
+		stock_pages = READ_ONCE(stock->nr_pages[i]);
+		if (stock_pages >= nr_pages) {
+			WRITE_ONCE(stock->nr_pages[i], stock_pages - nr_pages);
+			ret = true;
+		}
+		break;
 	}
 
 	local_unlock_irqrestore(&memcg_stock.stock_lock, flags);
@@ -1781,12 +1813,13 @@ static bool consume_stock(struct mem_cgroup *memcg, unsigned int nr_pages)
 }
 
 /*
- * Returns stocks cached in percpu and reset cached information.
+ * Returns the charge cached in stock slot @i and resets its cached
+ * information.
  */
-static void drain_stock(struct memcg_stock_pcp *stock)
+static void drain_stock(struct memcg_stock_pcp *stock, int i)
 {
-	unsigned int stock_pages = READ_ONCE(stock->nr_pages);
-	struct mem_cgroup *old = READ_ONCE(stock->cached);
+	unsigned int stock_pages = READ_ONCE(stock->nr_pages[i]);
+	struct mem_cgroup *old = READ_ONCE(stock->cached[i]);
 
 	if (!old)
 		return;
@@ -1796,11 +1829,19 @@ static void drain_stock(struct memcg_stock_pcp *stock)
 		if (do_memsw_account())
 			page_counter_uncharge(&old->memsw, stock_pages);
 
-		WRITE_ONCE(stock->nr_pages, 0);
+		WRITE_ONCE(stock->nr_pages[i], 0);
 	}
 
 	css_put(&old->css);
-	WRITE_ONCE(stock->cached, NULL);
+	WRITE_ONCE(stock->cached[i], NULL);
+}
+
+static void drain_stock_all(struct memcg_stock_pcp *stock)
+{
+	int i;
+
+	for (i = 0; i < NR_MEMCG_STOCK; i++)
+		drain_stock(stock, i);
 }
 
 static void drain_local_stock(struct work_struct *dummy)
@@ -1818,7 +1859,7 @@ static void drain_local_stock(struct work_struct *dummy)
 
 	stock = this_cpu_ptr(&memcg_stock);
 	old = drain_obj_stock(stock);
-	drain_stock(stock);
+	drain_stock_all(stock);
 	clear_bit(FLUSHING_CACHED_CHARGE, &stock->flags);
 
 	local_unlock_irqrestore(&memcg_stock.stock_lock, flags);
@@ -1833,18 +1874,45 @@ static void __refill_stock(struct mem_cgroup *memcg, unsigned int nr_pages)
 {
 	struct memcg_stock_pcp *stock;
 	unsigned int stock_pages;
+	int i, slot = -1;
 
 	stock = this_cpu_ptr(&memcg_stock);
-	if (READ_ONCE(stock->cached) != memcg) { /* reset if necessary */
-		drain_stock(stock);
+	for (i = 0; i < NR_MEMCG_STOCK; i++) {
+		struct mem_cgroup *cached = READ_ONCE(stock->cached[i]);
+
+		if (cached == memcg) {
+			slot = i;
+			break;
+		}
+		/* otherwise prefer an empty slot, then the emptiest one */
+		if (slot < 0 || (READ_ONCE(stock->cached[slot]) &&
+				 (!cached || READ_ONCE(stock->nr_pages[i]) <
+					     READ_ONCE(stock->nr_pages[slot]))))
+			slot = i;
+	}
+
+	/*
+	 * A refill larger than MEMCG_CHARGE_BATCH is the surplus of a large
+	 * folio charge and may fill the slot up to MEMCG_STOCK_MAX, so that it
+	 * serves the next few folios of that size.  If the slot's leftover
+	 * doesn't leave room for it, flush the leftover rather than the fresh
+	 * surplus.  Small refills on top of a full slot flush it as before.
+	 */
+	if (nr_pages > MEMCG_CHARGE_BATCH &&
+	    READ_ONCE(stock->nr_pages[slot]) + nr_pages > MEMCG_STOCK_MAX)
+		drain_stock(stock, slot);
+
+	if (READ_ONCE(stock->cached[slot]) != memcg) { /* reset if necessary */
+		drain_stock(stock, slot);
 		css_get(&memcg->css);
-		WRITE_ONCE(stock->cached, memcg);
+		WRITE_ONCE(stock->cached[slot], memcg);
 	}
-	stock_pages = READ_ONCE(stock->nr_pages) + nr_pages;
-	WRITE_ONCE(stock->nr_pages, stock_pages);
+	stock_pages = READ_ONCE(stock->nr_pages[slot]) + nr_pages;
+	WRITE_ONCE(stock->nr_pages[slot], stock_pages);
 
-	if (stock_pages > MEMCG_CHARGE_BATCH)
-		drain_stock(stock);
+	if (stock_pages > (nr_pages > MEMCG_CHARGE_BATCH ?
+			   MEMCG_STOCK_MAX : MEMCG_CHARGE_BATCH))
+		drain_stock(stock, slot);
 }
 
 static void refill_stock(struct mem_cgroup *memcg, unsigned int nr_pages)
@@ -1879,13 +1947,18 @@ void drain_all_stock(struct mem_cgroup *root_memcg)
 		struct memcg_stock_pcp *stock = &per_cpu(memcg_stock, cpu);
 		struct mem_cgroup *memcg;
 		bool flush = false;
+		int i;
 
 		rcu_read_lock();
-		memcg = READ_ONCE(stock->cached);
-		if (memcg && READ_ONCE(stock->nr_pages) &&
-		    mem_cgroup_is_descendant(memcg, root_memcg))
-			flush = true;
-		else if (obj_stock_flush_required(stock, root_memcg))
+		for (i = 0; i < NR_MEMCG_STOCK; i++) {
+			memcg = READ_ONCE(stock->cached[i]);
+			if (memcg && READ_ONCE(stock->nr_pages[i]) &&
+			    mem_cgroup_is_descendant(memcg, root_memcg)) {
+				flush = true;
+				break;
+			}
+		}
+		if (!flush && obj_stock_flush_required(stock, root_memcg))
 			flush = true;
 		rcu_read_unlock();
 
@@ -1906,7 +1979,7 @@ static int memcg_hotplug_cpu_dead(unsigned int cpu)
 	struct memcg_stock_pcp *stock;
 
 	stock = &per_cpu(memcg_stock, cpu);
-	drain_stock(stock);
+	drain_stock_all(stock);
 
 	return 0;
 }
@@ -2181,10 +2254,26 @@ void mem_cgroup_handle_over_high(gfp_t gfp_mask)
 	css_put(&memcg->css);
 }
 
+/*
+ * Charge size to try against the page_counter hierarchy for a request of
+ * @nr_pages. Order-0 and small charges round up to MEMCG_CHARGE_BATCH as
+ * before; large folios round up to a few folios' worth so that a stream of
+ * them doesn't hit the shared counters on every fault. The surplus lands in
+ * the per-cpu stock, and try_charge_memcg() falls back to the exact size if
+ * the batch doesn't fit under the limit.
+ */
+static unsigned int memcg_charge_batch(unsigned int nr_pages)
+{
+	if (nr_pages > 1 && nr_pages <= MEMCG_STOCK_MAX / 4)
+		return max(MEMCG_CHARGE_BATCH, 4 * nr_pages);
+
+	return max(MEMCG_CHARGE_BATCH, nr_pages);
+}
+
 int try_charge_memcg(struct mem_cgroup *memcg, gfp_t gfp_mask,
 		     unsigned int nr_pages)
 {
-	unsigned int batch = max(MEMCG_CHARGE_BATCH, nr_pages);
+	unsigned int batch = memcg_charge_batch(nr_pages);
 	int nr_retries = MAX_RECLAIM_RETRIES;
 	struct mem_cgroup *mem_over_limit;
 	struct page_counter *counter;
@@ -4214,7 +4303,7 @@ static int memory_events_local_show(struct seq_file *m, void *v)
 	return 0;
 }
 
-int memory_stat_show(struct seq_file *m, void *v)
+static int __memory_stat_show(struct seq_file *m, bool approx)
 {
 	struct mem_cgroup *memcg = mem_cgroup_from_seq(m);
 	char *buf = kmalloc(SEQ_BUF_SIZE, GFP_KERNEL);
@@ -4223,12 +4312,22 @@ int memory_stat_show(struct seq_file *m, void *v)
 	if (!buf)
 		return -ENOMEM;
 	seq_buf_init(&s, buf, SEQ_BUF_SIZE);
-	memory_stat_format(memcg, &s);
+	memory_stat_format(memcg, &s, approx);
 	seq_puts(m, buf);
 	kfree(buf);
 	return 0;
 }
 
+int memory_stat_show(struct seq_file *m, void *v)
+{
+	return __memory_stat_show(m, false);
+}
+
+static int memory_stat_approx_show(struct seq_file *m, void *v)
+{
+	return __memory_stat_show(m, true);
+}
+
 #ifdef CONFIG_NUMA
 static inline unsigned long lruvec_page_state_output(struct lruvec *lruvec,
 						     int item)
@@ -4428,6 +4527,10 @@ static struct cftype memory_files[] = {
 		.name = "stat",
 		.seq_show = memory_stat_show,
 	},
+	{
+		.name = "stat.approx",
+		.seq_show = memory_stat_approx_show,
+	},
 #ifdef CONFIG_NUMA
 	{
 		.name = "numa_stat",
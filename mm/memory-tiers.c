@@ -362,6 +362,53 @@ int next_demotion_node(int node)
 	return target;
 }
 
+/**
+ * next_promotion_node() - Get the next node in the promotion path
+ * @node: The starting node to lookup the next node
+ *
+ * Return: the closest node, by node distance, among the memory nodes of the
+ * nearest memory tier above the one of @node; NUMA_NO_NODE if @node is in
+ * the top tier.  Like next_demotion_node(), this does not keep the returned
+ * node online.
+ */
+int next_promotion_node(int node)
+{
+	struct memory_tier *memtier, *this;
+	int best_adist = -1, best_dist = INT_MAX;
+	int target = NUMA_NO_NODE;
+	int n;
+
+	if (!node_demotion)
+		return NUMA_NO_NODE;
+
+	rcu_read_lock();
+	this = rcu_dereference(NODE_DATA(node)->memtier);
+	if (!this || this->adistance_start <= top_tier_adistance)
+		goto out;
+
+	for_each_node_state(n, N_MEMORY) {
+		int dist;
+
+		memtier = rcu_dereference(NODE_DATA(n)->memtier);
+		if (!memtier || memtier->adistance_start >= this->adistance_start)
+			continue;
+		/* Only step up one tier at a time */
+		if (memtier->adistance_start < best_adist)
+			continue;
+
+		dist = node_distance(node, n);
+		if (memtier->adistance_start > best_adist || dist < best_dist) {
+			best_adist = memtier->adistance_start;
+			best_dist = dist;
+			target = n;
+		}
+	}
+out:
+	rcu_read_unlock();
+
+	return target;
+}
+
 static void disable_all_demotion_targets(void)
 {
 	struct memory_tier *memtier;
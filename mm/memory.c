@@ -4667,11 +4667,93 @@ static bool pte_range_none(pte_t *pte, int nr_pages)
 	return true;
 }
 
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+/* Number of density samples after which a VMA's mTHP order cap is revised */
+#define ANON_ORDER_SAMPLES	16
+
+/*
+ * Learn how densely a VMA is populated and limit the mTHP orders used on
+ * fault accordingly. Each fault that could use a large folio looks at the
+ * two equally sized ranges next to the naturally aligned range of the order
+ * it would use. If either already has pages mapped, the VMA is being filled
+ * densely, if both are empty it is touched sparsely. Once enough samples
+ * agree, the VMA's order cap is moved up or down by one order, so sparse
+ * heaps settle on small folios while densely used areas keep growing up to
+ * the largest enabled order.
+ *
+ * Only done when enabled through the adaptive_anon_order sysfs knob. @pte
+ * maps the page table covering the faulting address, @orders are the orders
+ * that fit the VMA around it and @enabled all orders enabled for the VMA.
+ */
+static unsigned long anon_fault_orders(struct vm_fault *vmf, pte_t *pte,
+				       unsigned long orders,
+				       unsigned long enabled)
+{
+	struct vm_area_struct *vma = vmf->vma;
+	int cap = READ_ONCE(vma->anon_order_cap);
+	unsigned long allowed = orders;
+	unsigned long addr, size, pmd_start;
+	unsigned int dense, sparse;
+	bool sampled = false, populated = false;
+	int order;
+
+	if (!transparent_hugepage_adaptive_anon_order())
+		return orders;
+
+	if (cap)
+		allowed &= BIT(cap + 1) - 1;
+
+	/*
+	 * Sample at the order that is about to be used or, if the cap rules
+	 * out all orders, at the smallest one to find out whether to grow.
+	 */
+	order = allowed ? highest_order(allowed) : __ffs(orders);
+	size = PAGE_SIZE << order;
+	addr = ALIGN_DOWN(vmf->address, size);
+	pmd_start = vmf->address & PMD_MASK;
+
+	if (addr > pmd_start && addr - size >= vma->vm_start) {
+		sampled = true;
+		populated |= !pte_range_none(pte + pte_index(addr - size),
+					     1 << order);
+	}
+	if (addr + 2 * size <= pmd_start + PMD_SIZE &&
+	    addr + 2 * size <= vma->vm_end) {
+		sampled = true;
+		populated |= !pte_range_none(pte + pte_index(addr + size),
+					     1 << order);
+	}
+	if (!sampled)
+		return allowed;
+
+	dense = READ_ONCE(vma->anon_order_dense) + populated;
+	sparse = READ_ONCE(vma->anon_order_sparse) + !populated;
+
+	if (dense + sparse >= ANON_ORDER_SAMPLES) {
+		bool in_use = allowed & BIT(order);
+
+		if (dense >= 3 * sparse)
+			cap = in_use ? order + 1 : order;
+		else if (sparse >= 3 * dense && in_use)
+			cap = order - 1;
+
+		if (cap >= highest_order(enabled))
+			cap = 0;
+		WRITE_ONCE(vma->anon_order_cap, cap);
+		dense = sparse = 0;
+	}
+	WRITE_ONCE(vma->anon_order_dense, dense);
+	WRITE_ONCE(vma->anon_order_sparse, sparse);
+
+	return allowed;
+}
+#endif
+
 static struct folio *alloc_anon_folio(struct vm_fault *vmf)
 {
 	struct vm_area_struct *vma = vmf->vma;
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
-	unsigned long orders;
+	unsigned long orders, enabled;
 	struct folio *folio;
 	unsigned long addr;
 	pte_t *pte;
@@ -4690,9 +4772,9 @@ static struct folio *alloc_anon_folio(struct vm_fault *vmf)
 	 * for this vma. Then filter out the orders that can't be allocated over
 	 * the faulting address and still be fully contained in the vma.
 	 */
-	orders = thp_vma_allowable_orders(vma, vma->vm_flags,
+	enabled = thp_vma_allowable_orders(vma, vma->vm_flags,
 			TVA_IN_PF | TVA_ENFORCE_SYSFS, BIT(PMD_ORDER) - 1);
-	orders = thp_vma_suitable_orders(vma, vmf->address, orders);
+	orders = thp_vma_suitable_orders(vma, vmf->address, enabled);
 
 	if (!orders)
 		goto fallback;
@@ -4701,6 +4783,12 @@ static struct folio *alloc_anon_folio(struct vm_fault *vmf)
 	if (!pte)
 		return ERR_PTR(-EAGAIN);
 
+	orders = anon_fault_orders(vmf, pte, orders, enabled);
+	if (!orders) {
+		pte_unmap(pte);
+		goto fallback;
+	}
+
 	/*
 	 * Find the highest order where the aligned range is completely
 	 * pte_none(). Note that all remaining orders will be completely
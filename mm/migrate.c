@@ -44,6 +44,9 @@
 #include <linux/sched/sysctl.h>
 #include <linux/memory-tiers.h>
 #include <linux/pagewalk.h>
+#include <linux/highmem.h>
+#include <linux/sysctl.h>
+#include <linux/workqueue.h>
 
 #include <asm/tlbflush.h>
 
@@ -546,10 +549,14 @@ static int __folio_migrate_mapping(struct address_space *mapping,
 	}
 
 	/* Swap cache still stores N entries instead of a high-order entry */
+	if (!folio_test_swapcache(folio))
+		write_seqcount_begin(&mapping->i_pages_delete_seqcnt);
 	for (i = 0; i < entries; i++) {
 		xas_store(&xas, newfolio);
 		xas_next(&xas);
 	}
+	if (!folio_test_swapcache(folio))
+		write_seqcount_end(&mapping->i_pages_delete_seqcnt);
 
 	/*
 	 * Drop cache reference from old folio by unfreezing
@@ -1022,6 +1029,26 @@ static int fallback_migrate_folio(struct address_space *mapping,
 	return migrate_folio(mapping, dst, src, mode);
 }
 
+/*
+ * Like migrate_folio(), for a folio whose contents migrate_pages_precopy()
+ * has already copied to @dst.
+ */
+static int migrate_copied_folio(struct address_space *mapping,
+				struct folio *dst, struct folio *src)
+{
+	int rc, expected_count = folio_expected_refs(mapping, src);
+
+	if (folio_ref_count(src) != expected_count)
+		return -EAGAIN;
+
+	rc = __folio_migrate_mapping(mapping, dst, src, expected_count);
+	if (rc != MIGRATEPAGE_SUCCESS)
+		return rc;
+
+	folio_migrate_flags(dst, src);
+	return MIGRATEPAGE_SUCCESS;
+}
+
 /*
  * Move a page to a newly allocated page
  * The page is locked and all ptes have been successfully removed.
@@ -1034,7 +1061,7 @@ static int fallback_migrate_folio(struct address_space *mapping,
  *  MIGRATEPAGE_SUCCESS - success
  */
 static int move_to_new_folio(struct folio *dst, struct folio *src,
-				enum migrate_mode mode)
+				enum migrate_mode mode, bool copied)
 {
 	int rc = -EAGAIN;
 	bool is_lru = !__folio_test_movable(src);
@@ -1045,7 +1072,9 @@ static int move_to_new_folio(struct folio *dst, struct folio *src,
 	if (likely(is_lru)) {
 		struct address_space *mapping = folio_mapping(src);
 
-		if (!mapping)
+		if (copied)
+			rc = migrate_copied_folio(mapping, dst, src);
+		else if (!mapping)
 			rc = migrate_folio(mapping, dst, src, mode);
 		else if (mapping_inaccessible(mapping))
 			rc = -EOPNOTSUPP;
@@ -1353,7 +1382,7 @@ static int migrate_folio_unmap(new_folio_t get_new_folio,
 static int migrate_folio_move(free_folio_t put_new_folio, unsigned long private,
 			      struct folio *src, struct folio *dst,
 			      enum migrate_mode mode, enum migrate_reason reason,
-			      struct list_head *ret)
+			      struct list_head *ret, bool copied)
 {
 	int rc;
 	int old_page_state = 0;
@@ -1365,7 +1394,7 @@ static int migrate_folio_move(free_folio_t put_new_folio, unsigned long private,
 	prev = dst->lru.prev;
 	list_del(&dst->lru);
 
-	rc = move_to_new_folio(dst, src, mode);
+	rc = move_to_new_folio(dst, src, mode, copied);
 	if (rc)
 		goto out;
 
@@ -1520,7 +1549,7 @@ static int unmap_and_move_huge_page(new_folio_t get_new_folio,
 	}
 
 	if (!folio_mapped(src))
-		rc = move_to_new_folio(dst, src, mode);
+		rc = move_to_new_folio(dst, src, mode, false);
 
 	if (page_was_mapped)
 		remove_migration_ptes(src,
@@ -1695,6 +1724,204 @@ static int migrate_hugetlbs(struct list_head *from, new_folio_t get_new_folio,
 	return nr_failed;
 }
 
+/*
+ * Number of extra threads that help copying a batch of unmapped anonymous
+ * folios before they are moved; 0 disables it.
+ */
+static unsigned int sysctl_migrate_copy_workers __read_mostly;
+static struct workqueue_struct *migrate_copy_wq __read_mostly;
+
+#define MIGRATE_COPY_MAX_WORKERS	8
+/* Batches smaller than this are not worth spreading out */
+#define MIGRATE_COPY_MIN_PAGES		(NR_MAX_BATCHED_MIGRATION / 4)
+/* Only the first folios of a batch are tracked for copying ahead */
+#define MIGRATE_COPY_MAX_FOLIOS		512
+
+struct migrate_copy_work {
+	struct work_struct work;
+	struct list_head *src_folios;
+	struct list_head *dst_folios;
+	unsigned long *precopy;
+	/* range of pages, counted over the precopy folios, to copy */
+	unsigned long start;
+	unsigned long end;
+	int rc;
+};
+
+/*
+ * Only anonymous folios are copied ahead of the move, as their migration is
+ * plain migrate_folio() which we can replicate without the copy.
+ */
+static bool migrate_folio_can_precopy(struct folio *src, struct folio *dst)
+{
+	struct address_space *mapping;
+
+	if (!folio_test_anon(src) || folio_test_ksm(src) ||
+	    folio_is_zone_device(dst))
+		return false;
+
+	mapping = folio_mapping(src);
+	return !mapping || mapping->a_ops->migrate_folio == migrate_folio;
+}
+
+static int migrate_copy_range(struct list_head *src_folios,
+			      struct list_head *dst_folios,
+			      unsigned long *precopy,
+			      unsigned long start, unsigned long end)
+{
+	struct folio *src, *dst;
+	unsigned long pos = 0;
+	unsigned int idx = 0;
+
+	dst = list_first_entry(dst_folios, struct folio, lru);
+	list_for_each_entry(src, src_folios, lru) {
+		unsigned long nr = folio_nr_pages(src);
+		unsigned long i;
+
+		if (pos >= end || idx >= MIGRATE_COPY_MAX_FOLIOS)
+			break;
+
+		if (test_bit(idx, precopy)) {
+			if (pos + nr > start) {
+				for (i = max(start, pos) - pos;
+				     i < min(end, pos + nr) - pos; i++) {
+					if (copy_mc_highpage(folio_page(dst, i),
+							     folio_page(src, i)))
+						return -EHWPOISON;
+				}
+				cond_resched();
+			}
+			pos += nr;
+		}
+		dst = list_next_entry(dst, lru);
+		idx++;
+	}
+
+	return 0;
+}
+
+static void migrate_copy_work_fn(struct work_struct *work)
+{
+	struct migrate_copy_work *w = container_of(work,
+			struct migrate_copy_work, work);
+
+	w->rc = migrate_copy_range(w->src_folios, w->dst_folios, w->precopy,
+				   w->start, w->end);
+}
+
+/*
+ * Copy the contents of the eligible folios of an unmapped batch, with the
+ * work spread across sysctl_migrate_copy_workers unbound workers plus the
+ * caller. On return, @precopy has a bit set for every folio, by position in
+ * the batch, whose contents were copied so the move phase can skip it.
+ *
+ * A folio is only copied if nothing but the migration holds a reference to
+ * it: once it is unmapped and the TLBs are flushed, no new writer can show
+ * up, while a reference taken earlier (e.g. through GUP) could still be
+ * used to write to it after the copy.
+ */
+static void migrate_pages_precopy(struct list_head *src_folios,
+				  struct list_head *dst_folios,
+				  unsigned long *precopy)
+{
+	struct migrate_copy_work works[MIGRATE_COPY_MAX_WORKERS];
+	unsigned int nr_workers = READ_ONCE(sysctl_migrate_copy_workers);
+	unsigned long nr_pages = 0, per_worker, start;
+	struct folio *src, *dst;
+	bool copied = true;
+	unsigned int i, idx = 0;
+
+	bitmap_zero(precopy, MIGRATE_COPY_MAX_FOLIOS);
+
+	/*
+	 * Waiting for workers while holding a batch of folio locks must not
+	 * be needed to make progress in reclaim or direct compaction.
+	 */
+	if (!nr_workers || !migrate_copy_wq || (current->flags & PF_MEMALLOC))
+		return;
+	if (list_empty(src_folios))
+		return;
+	nr_workers = min(nr_workers, MIGRATE_COPY_MAX_WORKERS);
+
+	dst = list_first_entry(dst_folios, struct folio, lru);
+	list_for_each_entry(src, src_folios, lru) {
+		if (idx >= MIGRATE_COPY_MAX_FOLIOS)
+			break;
+		if (migrate_folio_can_precopy(src, dst) &&
+		    folio_ref_count(src) ==
+		    folio_expected_refs(folio_mapping(src), src)) {
+			__set_bit(idx, precopy);
+			nr_pages += folio_nr_pages(src);
+		}
+		dst = list_next_entry(dst, lru);
+		idx++;
+	}
+	if (nr_pages < MIGRATE_COPY_MIN_PAGES) {
+		bitmap_zero(precopy, MIGRATE_COPY_MAX_FOLIOS);
+		return;
+	}
+
+	/* The caller copies the first share itself */
+	per_worker = DIV_ROUND_UP(nr_pages, nr_workers + 1);
+	start = per_worker;
+	for (i = 0; i < nr_workers && start < nr_pages; i++) {
+		struct migrate_copy_work *w = &works[i];
+
+		w->src_folios = src_folios;
+		w->dst_folios = dst_folios;
+		w->precopy = precopy;
+		w->start = start;
+		w->end = min(start + per_worker, nr_pages);
+		w->rc = 0;
+		INIT_WORK_ONSTACK(&w->work, migrate_copy_work_fn);
+		queue_work(migrate_copy_wq, &w->work);
+		start = w->end;
+	}
+	nr_workers = i;
+
+	if (migrate_copy_range(src_folios, dst_folios, precopy, 0,
+			       min(per_worker, nr_pages)))
+		copied = false;
+
+	for (i = 0; i < nr_workers; i++) {
+		flush_work(&works[i].work);
+		destroy_work_on_stack(&works[i].work);
+		if (works[i].rc)
+			copied = false;
+	}
+
+	if (!copied)
+		bitmap_zero(precopy, MIGRATE_COPY_MAX_FOLIOS);
+}
+
+#ifdef CONFIG_SYSCTL
+static const unsigned int migrate_copy_max_workers = MIGRATE_COPY_MAX_WORKERS;
+
+static struct ctl_table migrate_sysctl_table[] = {
+	{
+		.procname	= "migrate_copy_workers",
+		.data		= &sysctl_migrate_copy_workers,
+		.maxlen		= sizeof(sysctl_migrate_copy_workers),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= (void *)&migrate_copy_max_workers,
+	},
+};
+
+static int __init migrate_copy_init(void)
+{
+	migrate_copy_wq = alloc_workqueue("migrate_copy",
+					  WQ_UNBOUND | WQ_MEM_RECLAIM, 0);
+	if (!migrate_copy_wq)
+		return -ENOMEM;
+
+	register_sysctl_init("vm", migrate_sysctl_table);
+	return 0;
+}
+late_initcall(migrate_copy_init);
+#endif
+
 /*
  * migrate_pages_batch() first unmaps folios in the from list as many as
  * possible, then move the unmapped folios.
@@ -1722,6 +1949,8 @@ static int migrate_pages_batch(struct list_head *from,
 	LIST_HEAD(unmap_folios);
 	LIST_HEAD(dst_folios);
 	bool nosplit = (reason == MR_NUMA_MISPLACED);
+	DECLARE_BITMAP(precopied, MIGRATE_COPY_MAX_FOLIOS);
+	unsigned int idx;
 
 	VM_WARN_ON_ONCE(mode != MIGRATE_ASYNC &&
 			!list_empty(from) && !list_is_singular(from));
@@ -1882,12 +2111,15 @@ static int migrate_pages_batch(struct list_head *from,
 	/* Flush TLBs for all unmapped folios */
 	try_to_unmap_flush();
 
+	migrate_pages_precopy(&unmap_folios, &dst_folios, precopied);
+
 	retry = 1;
 	for (pass = 0; pass < nr_pass && retry; pass++) {
 		retry = 0;
 		thp_retry = 0;
 		nr_retry_pages = 0;
 
+		idx = 0;
 		dst = list_first_entry(&dst_folios, struct folio, lru);
 		dst2 = list_next_entry(dst, lru);
 		list_for_each_entry_safe(folio, folio2, &unmap_folios, lru) {
@@ -1896,9 +2128,13 @@ static int migrate_pages_batch(struct list_head *from,
 
 			cond_resched();
 
+			/* Only the first pass sees the batch in its original order */
 			rc = migrate_folio_move(put_new_folio, private,
 						folio, dst, mode,
-						reason, ret_folios);
+						reason, ret_folios,
+						!pass && idx < MIGRATE_COPY_MAX_FOLIOS &&
+						test_bit(idx, precopied));
+			idx++;
 			/*
 			 * The rules are:
 			 *	Success: folio will be freed
@@ -1273,9 +1273,10 @@ static void wb_update_write_bandwidth(struct bdi_writeback *wb,
 				      unsigned long elapsed,
 				      unsigned long written)
 {
-	const unsigned long period = roundup_pow_of_two(3 * HZ);
+	unsigned long period = roundup_pow_of_two(3 * HZ);
 	unsigned long avg = wb->avg_write_bandwidth;
 	unsigned long old = wb->write_bandwidth;
+	unsigned int avg_shift = 3;
 	u64 bw;
 
 	/*
@@ -1290,6 +1291,23 @@ static void wb_update_write_bandwidth(struct bdi_writeback *wb,
 	 */
 	bw = written - min(written, wb->written_stamp);
 	bw *= HZ;
+
+	/*
+	 * If the device speed changed a lot (e.g. it went from streaming to
+	 * seeking, or a remote target slowed down), the 3s period takes many
+	 * intervals to follow. Track such large deviations with a 4 times
+	 * shorter period and less smoothing, so that throttling adapts within
+	 * a second or so rather than overshooting or starving the device.
+	 */
+	if (old && elapsed >= BANDWIDTH_INTERVAL) {
+		u64 cur = div64_ul(bw, elapsed);
+
+		if (cur > 2ULL * old || 2 * cur < old) {
+			period >>= 2;
+			avg_shift = 1;
+		}
+	}
+
 	if (unlikely(elapsed > period)) {
 		bw = div64_ul(bw, elapsed);
 		avg = bw;
@@ -1302,10 +1320,10 @@ static void wb_update_write_bandwidth(struct bdi_writeback *wb,
 	 * one more level of smoothing, for filtering out sudden spikes
 	 */
 	if (avg > old && old >= (unsigned long)bw)
-		avg -= (avg - old) >> 3;
+		avg -= (avg - old) >> avg_shift;
 
 	if (avg < old && old <= (unsigned long)bw)
-		avg += (old - avg) >> 3;
+		avg += (old - avg) >> avg_shift;
 
 out:
 	/* keep avg > 0 to guarantee that tot > 0 if there are dirty wbs */
@@ -1802,6 +1820,61 @@ static void balance_domain_limits(struct dirty_throttle_control *dtc,
 	domain_dirty_freerun(dtc, strictlimit);
 }
 
+/*
+ * Remember the global limits for balance_dirty_fast_freerun(). RT tasks get
+ * boosted limits in domain_dirty_limits(), don't let them leak to others.
+ */
+static void domain_save_fast_limits(struct dirty_throttle_control *dtc,
+				    unsigned long now)
+{
+	struct wb_domain *dom = dtc_dom(dtc);
+
+	if (rt_or_dl_task(current))
+		return;
+	if (READ_ONCE(dom->fast_limit_tstamp) == now)
+		return;
+
+	WRITE_ONCE(dom->fast_bg_thresh, dtc->bg_thresh);
+	WRITE_ONCE(dom->fast_freerun,
+		   dirty_freerun_ceiling(dtc->thresh, dtc->bg_thresh));
+	WRITE_ONCE(dom->fast_limit_tstamp, now);
+}
+
+/*
+ * Fast path for tasks dirtying pages while the system is well below the dirty
+ * limits: if the global dirty count is below the background threshold computed
+ * in the last BANDWIDTH_INTERVAL, neither background writeback nor throttling
+ * can be due, so just re-arm the task's ratelimit without recomputing the
+ * dirtyable memory and the global and wb limits. memcg domains and strictlimit
+ * bdis depend on per-wb state and always take the full path.
+ */
+static bool balance_dirty_fast_freerun(struct bdi_writeback *wb,
+				       bool has_mdtc, bool strictlimit)
+{
+	struct wb_domain *dom = &global_wb_domain;
+	unsigned long now = jiffies;
+	unsigned long dirty;
+
+	if (has_mdtc || strictlimit || wb->dirty_exceeded)
+		return false;
+	if (rt_or_dl_task(current))
+		return false;
+	if (time_after(now, READ_ONCE(dom->fast_limit_tstamp) +
+			    BANDWIDTH_INTERVAL))
+		return false;
+
+	dirty = global_node_page_state(NR_FILE_DIRTY) +
+		global_node_page_state(NR_WRITEBACK);
+	if (dirty >= READ_ONCE(dom->fast_bg_thresh))
+		return false;
+
+	current->dirty_paused_when = now;
+	current->nr_dirtied = 0;
+	current->nr_dirtied_pause = dirty_poll_interval(dirty,
+						READ_ONCE(dom->fast_freerun));
+	return true;
+}
+
 static void wb_dirty_freerun(struct dirty_throttle_control *dtc,
 			     bool strictlimit)
 {
@@ -1874,12 +1947,16 @@ static int balance_dirty_pages(struct bdi_writeback *wb,
 	unsigned long start_time = jiffies;
 	int ret = 0;
 
+	if (balance_dirty_fast_freerun(wb, mdtc, strictlimit))
+		return 0;
+
 	for (;;) {
 		unsigned long now = jiffies;
 
 		nr_dirty = global_node_page_state(NR_FILE_DIRTY);
 
 		balance_domain_limits(gdtc, strictlimit);
+		domain_save_fast_limits(gdtc, now);
 		if (mdtc) {
 			/*
 			 * If @wb belongs to !root memcg, repeat the same
@@ -2336,22 +2336,36 @@ static int rmqueue_bulk(struct zone *zone, unsigned int order,
  */
 int decay_pcp_high(struct zone *zone, struct per_cpu_pages *pcp)
 {
-	int high_min, to_drain, batch;
+	int high_min, high_floor, to_drain, batch;
 	int todo = 0;
 
 	high_min = READ_ONCE(pcp->high_min);
 	batch = READ_ONCE(pcp->batch);
+
+	/*
+	 * Track how many pages this CPU had to move from and to the zone
+	 * since the last decay.  A CPU that keeps going to the zone in
+	 * bursts keeps a pcp->high large enough to absorb a typical burst,
+	 * unless the zone is short on memory.
+	 */
+	pcp->high_demand = (pcp->high_demand + pcp->zone_xfer) >> 1;
+	pcp->zone_xfer = 0;
+	high_floor = high_min;
+	if (!test_bit(ZONE_RECLAIM_ACTIVE, &zone->flags) &&
+	    !test_bit(ZONE_BELOW_HIGH, &zone->flags))
+		high_floor = clamp(pcp->high_demand, high_min,
+				   READ_ONCE(pcp->high_max));
+
 	/*
 	 * Decrease pcp->high periodically to try to free possible
 	 * idle PCP pages.  And, avoid to free too many pages to
 	 * control latency.  This caps pcp->high decrement too.
 	 */
-	if (pcp->high > high_min) {
+	if (pcp->high > high_floor)
 		pcp->high = max3(pcp->count - (batch << CONFIG_PCP_BATCH_SCALE_MAX),
-				 pcp->high - (pcp->high >> 3), high_min);
-		if (pcp->high > high_min)
-			todo++;
-	}
+				 pcp->high - (pcp->high >> 3), high_floor);
+	if (pcp->high > high_min || pcp->high_demand)
+		todo++;
 
 	to_drain = pcp->count - pcp->high;
 	if (to_drain > 0) {
@@ -2631,8 +2645,11 @@ static void free_unref_page_commit(struct zone *zone, struct per_cpu_pages *pcp,
 		pcp->free_count += (1 << order);
 	high = nr_pcp_high(pcp, zone, batch, free_high);
 	if (pcp->count >= high) {
-		free_pcppages_bulk(zone, nr_pcp_free(pcp, batch, high, free_high),
-				   pcp, pindex);
+		int to_free = nr_pcp_free(pcp, batch, high, free_high);
+
+		if (!free_high)
+			pcp->zone_xfer += to_free;
+		free_pcppages_bulk(zone, to_free, pcp, pindex);
 		if (test_bit(ZONE_BELOW_HIGH, &zone->flags) &&
 		    zone_watermark_ok(zone, 0, high_wmark_pages(zone),
 				      ZONE_MOVABLE, 0))
@@ -2935,6 +2952,9 @@ struct page *rmqueue_buddy(struct zone *preferred_zone, struct zone *zone,
 	return page;
 }
 
+/* Fraction of the recent zone traffic used as the minimum refill batch */
+#define PCP_DEMAND_BATCH_SHIFT	3
+
 static int nr_pcp_alloc(struct per_cpu_pages *pcp, struct zone *zone, int order)
 {
 	int high, base_batch, batch, max_nr_alloc;
@@ -2949,10 +2969,18 @@ static int nr_pcp_alloc(struct per_cpu_pages *pcp, struct zone *zone, int order)
 	if (unlikely(high < base_batch))
 		return 1;
 
-	if (order)
+	if (order) {
 		batch = base_batch;
-	else
+	} else {
 		batch = (base_batch << pcp->alloc_factor);
+		/*
+		 * A CPU that recently had to refill from the zone a lot
+		 * starts out with a larger batch instead of ramping up
+		 * alloc_factor again on every burst.
+		 */
+		batch = max(batch, min(pcp->high_demand >> PCP_DEMAND_BATCH_SHIFT,
+				       base_batch << CONFIG_PCP_BATCH_SCALE_MAX));
+	}
 
 	/*
 	 * If we had larger pcp->high, we could avoid to allocate from
@@ -3005,6 +3033,7 @@ struct page *__rmqueue_pcplist(struct zone *zone, unsigned int order,
 					migratetype, alloc_flags);
 
 			pcp->count += alloced << order;
+			pcp->zone_xfer += alloced << order;
 			if (unlikely(list_empty(list)))
 				return NULL;
 		}
@@ -4281,6 +4310,10 @@ __alloc_pages_slowpath(gfp_t gfp_mask, unsigned int order,
 	if (alloc_flags & ALLOC_KSWAPD)
 		wake_all_kswapds(order, gfp_mask, ac);
 
+	if (order)
+		compaction_note_demand(zone_pgdat(zonelist_zone(ac->preferred_zoneref)),
+				       order, false);
+
 	/*
 	 * The adjusted alloc_flags might result in immediate success, so try
 	 * that first
@@ -4481,6 +4514,9 @@ __alloc_pages_slowpath(gfp_t gfp_mask, unsigned int order,
 		goto retry;
 	}
 fail:
+	if (order && zonelist_zone(ac->preferred_zoneref))
+		compaction_note_demand(zone_pgdat(zonelist_zone(ac->preferred_zoneref)),
+				       order, true);
 	warn_alloc(gfp_mask, ac->nodemask,
 			"page allocation failure: order:%u", order);
 got_pg:
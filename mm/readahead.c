@@ -143,6 +143,18 @@ file_ra_state_init(struct file_ra_state *ra, struct address_space *mapping)
 }
 EXPORT_SYMBOL_GPL(file_ra_state_init);
 
+static struct folio *ractl_alloc_folio(struct readahead_control *ractl,
+		gfp_t gfp_mask, unsigned int order)
+{
+	struct folio *folio;
+
+	folio = filemap_alloc_folio(gfp_mask, order);
+	if (folio && ractl->dropbehind)
+		__folio_set_dropbehind(folio);
+
+	return folio;
+}
+
 static void read_pages(struct readahead_control *rac)
 {
 	const struct address_space_operations *aops = rac->mapping->a_ops;
@@ -265,8 +277,8 @@ void page_cache_ra_unbounded(struct readahead_control *ractl,
 			continue;
 		}
 
-		folio = filemap_alloc_folio(gfp_mask,
-					    mapping_min_folio_order(mapping));
+		folio = ractl_alloc_folio(ractl, gfp_mask,
+					  mapping_min_folio_order(mapping));
 		if (!folio)
 			break;
 
@@ -436,7 +448,7 @@ static inline int ra_alloc_folio(struct readahead_control *ractl, pgoff_t index,
 		pgoff_t mark, unsigned int order, gfp_t gfp)
 {
 	int err;
-	struct folio *folio = filemap_alloc_folio(gfp, order);
+	struct folio *folio = ractl_alloc_folio(ractl, gfp, order);
 
 	if (!folio)
 		return -ENOMEM;
@@ -524,6 +536,80 @@ void page_cache_ra_order(struct readahead_control *ractl,
 	do_page_cache_ra(ractl, ra->size, ra->async_size);
 }
 
+/*
+ * A stream found in the page cache history has already been running for a
+ * while and is likely to keep going, so start it off with folios large enough
+ * that a handful of them cover the window of @nr_pages instead of ramping up
+ * from order-0.  page_cache_ra_order() bumps the order it is passed by two,
+ * so aim for four folios per window, two orders below the window size.
+ */
+static unsigned int ra_stream_order(unsigned long nr_pages)
+{
+	if (nr_pages < 64)
+		return 0;
+	return ilog2(nr_pages) - 4;
+}
+
+/*
+ * Number of further reads that must repeat the stride of a read before
+ * strided readahead kicks in, and the maximum number of records read ahead
+ * (as a power of 2).
+ */
+#define RA_STRIDE_MIN_HITS	1
+#define RA_STRIDE_MAX_DEPTH	5
+
+/*
+ * Detect reads that skip a constant number of pages between them, as done when
+ * scanning a single column of a columnar file, and read ahead the next records
+ * of the stride along with the current one.  The stride is measured from the
+ * end of the previous read to the start of the current one, so it does not
+ * depend on the record size.  The number of records read ahead doubles for
+ * every further strided miss, bounded by the readahead window.
+ *
+ * Returns true if the current read has been issued.
+ */
+static bool page_cache_stride_ra(struct readahead_control *ractl,
+		pgoff_t prev_index, unsigned long req_count,
+		unsigned long max_pages)
+{
+	struct file_ra_state *ra = ractl->ra;
+	pgoff_t index = readahead_index(ractl);
+	unsigned long gap, depth;
+	pgoff_t next = index;
+
+	if (index <= prev_index + 1 || index - prev_index > UINT_MAX) {
+		ra->stride = 0;
+		ra->stride_hits = 0;
+		return false;
+	}
+
+	gap = index - prev_index;
+	if (gap != ra->stride) {
+		ra->stride = gap;
+		ra->stride_hits = 0;
+		return false;
+	}
+	if (ra->stride_hits < RA_STRIDE_MIN_HITS + RA_STRIDE_MAX_DEPTH)
+		ra->stride_hits++;
+	if (ra->stride_hits < RA_STRIDE_MIN_HITS)
+		return false;
+
+	do_page_cache_ra(ractl, req_count, 0);
+
+	/*
+	 * The predicted start may be one page too far if the records are not
+	 * page aligned, so read one extra page in front of each record.
+	 */
+	depth = min(1UL << (ra->stride_hits - RA_STRIDE_MIN_HITS),
+		    max_pages / (req_count + 1));
+	while (depth--) {
+		next += req_count + gap;
+		ractl->_index = next - 1;
+		do_page_cache_ra(ractl, req_count + 1, 0);
+	}
+	return true;
+}
+
 static unsigned long ractl_max_pages(struct readahead_control *ractl,
 		unsigned long req_size)
 {
@@ -547,6 +633,7 @@ void page_cache_sync_ra(struct readahead_control *ractl,
 	struct file_ra_state *ra = ractl->ra;
 	unsigned long max_pages, contig_count;
 	pgoff_t prev_index, miss;
+	unsigned int order = 0;
 
 	/*
 	 * Even if readahead is disabled, issue this request as readahead
@@ -591,10 +678,13 @@ void page_cache_sync_ra(struct readahead_control *ractl,
 	rcu_read_unlock();
 	contig_count = index - miss - 1;
 	/*
-	 * Standalone, small random read. Read as is, and do not pollute the
-	 * readahead state.
+	 * Standalone, small random read.  Unless it is part of a strided
+	 * scan, read as is, and do not pollute the readahead state.
 	 */
 	if (contig_count <= req_count) {
+		if (page_cache_stride_ra(ractl, prev_index, req_count,
+					 max_pages))
+			return;
 		do_page_cache_ra(ractl, req_count, 0);
 		return;
 	}
@@ -607,9 +697,10 @@ void page_cache_sync_ra(struct readahead_control *ractl,
 	ra->start = index;
 	ra->size = min(contig_count + req_count, max_pages);
 	ra->async_size = 1;
+	order = ra_stream_order(ra->size);
 readit:
 	ractl->_index = ra->start;
-	page_cache_ra_order(ractl, ra, 0);
+	page_cache_ra_order(ractl, ra, order);
 }
 EXPORT_SYMBOL_GPL(page_cache_sync_ra);
 
@@ -754,7 +845,7 @@ void readahead_expand(struct readahead_control *ractl,
 		if (folio && !xa_is_value(folio))
 			return; /* Folio apparently present */
 
-		folio = filemap_alloc_folio(gfp_mask, min_order);
+		folio = ractl_alloc_folio(ractl, gfp_mask, min_order);
 		if (!folio)
 			return;
 
@@ -783,7 +874,7 @@ void readahead_expand(struct readahead_control *ractl,
 		if (folio && !xa_is_value(folio))
 			return; /* Folio apparently present */
 
-		folio = filemap_alloc_folio(gfp_mask, min_order);
+		folio = ractl_alloc_folio(ractl, gfp_mask, min_order);
 		if (!folio)
 			return;
 
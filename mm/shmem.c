@@ -529,12 +529,16 @@ static bool shmem_confirm_swap(struct address_space *mapping,
  *	also respect fadvise()/madvise() hints;
  * SHMEM_HUGE_ADVISE:
  *	only allocate huge pages if requested with fadvise()/madvise();
+ * SHMEM_HUGE_ADAPTIVE:
+ *	allocate large folios of any order that fits within i_size, growing
+ *	with sequentially written files, also respect fadvise()/madvise() hints;
  */
 
 #define SHMEM_HUGE_NEVER	0
 #define SHMEM_HUGE_ALWAYS	1
 #define SHMEM_HUGE_WITHIN_SIZE	2
 #define SHMEM_HUGE_ADVISE	3
+#define SHMEM_HUGE_ADAPTIVE	4
 
 /*
  * Special values.
@@ -573,6 +577,7 @@ static bool shmem_huge_global_enabled(struct inode *inode, pgoff_t index,
 	case SHMEM_HUGE_ALWAYS:
 		return true;
 	case SHMEM_HUGE_WITHIN_SIZE:
+	case SHMEM_HUGE_ADAPTIVE:
 		index = round_up(index + 1, HPAGE_PMD_NR);
 		i_size = max(write_end, i_size_read(inode));
 		i_size = round_up(i_size, PAGE_SIZE);
@@ -634,6 +639,8 @@ static const char *shmem_format_huge(int huge)
 		return "within_size";
 	case SHMEM_HUGE_ADVISE:
 		return "advise";
+	case SHMEM_HUGE_ADAPTIVE:
+		return "adaptive";
 	case SHMEM_HUGE_DENY:
 		return "deny";
 	case SHMEM_HUGE_FORCE:
@@ -1682,6 +1689,44 @@ bool shmem_hpage_pmd_enabled(void)
 	return false;
 }
 
+/*
+ * huge=adaptive: rather than all-or-nothing PMD sized folios, use the
+ * largest order whose folio lies fully within the file, counting the write
+ * in progress. A file written sequentially is expected to keep growing, so
+ * it may use folios as large as what has been written so far, doubling the
+ * way readahead ramps up. Small files thus stay in small folios while large
+ * or growing ones work their way up to PMD size, and the tail beyond i_size
+ * is at most as large as the data already written.
+ */
+static unsigned long shmem_adaptive_orders(struct inode *inode, pgoff_t index,
+					   loff_t write_end,
+					   unsigned long vm_flags)
+{
+	unsigned long orders = THP_ORDERS_ALL_FILE_DEFAULT;
+	pgoff_t end;
+	int order;
+
+	if (!S_ISREG(inode->i_mode) || shmem_huge == SHMEM_HUGE_DENY)
+		return 0;
+	if (!mapping_large_folio_support(inode->i_mapping))
+		return 0;
+	if (vm_flags & VM_HUGEPAGE)
+		return orders;
+
+	end = DIV_ROUND_UP(max(write_end, i_size_read(inode)), PAGE_SIZE);
+	if (index && READ_ONCE(SHMEM_I(inode)->write_index) == index)
+		end = max(end, 2 * index);
+
+	order = highest_order(orders);
+	while (orders) {
+		if (round_up(index + 1, 1UL << order) <= end)
+			break;
+		order = next_order(&orders, order);
+	}
+
+	return orders;
+}
+
 unsigned long shmem_allowable_huge_orders(struct inode *inode,
 				struct vm_area_struct *vma, pgoff_t index,
 				loff_t write_end, bool shmem_huge_force)
@@ -1700,6 +1745,10 @@ unsigned long shmem_allowable_huge_orders(struct inode *inode,
 	global_huge = shmem_huge_global_enabled(inode, index, write_end,
 						shmem_huge_force, vm_flags);
 	if (!vma || !vma_is_anon_shmem(vma)) {
+		if (SHMEM_SB(inode->i_sb)->huge == SHMEM_HUGE_ADAPTIVE &&
+		    !shmem_huge_force && shmem_huge != SHMEM_HUGE_FORCE)
+			return shmem_adaptive_orders(inode, index, write_end,
+						     vm_flags);
 		/*
 		 * For tmpfs, we now only support PMD sized THP if huge page
 		 * is enabled, otherwise fallback to order 0.
@@ -3141,6 +3190,9 @@ shmem_write_end(struct file *file, struct address_space *mapping,
 
 	if (pos + copied > inode->i_size)
 		i_size_write(inode, pos + copied);
+	if (SHMEM_SB(inode->i_sb)->huge == SHMEM_HUGE_ADAPTIVE)
+		WRITE_ONCE(SHMEM_I(inode)->write_index,
+			   DIV_ROUND_UP(pos + copied, PAGE_SIZE));
 
 	if (!folio_test_uptodate(folio)) {
 		if (copied < folio_size(folio)) {
@@ -4333,6 +4385,7 @@ static const struct constant_table shmem_param_enums_huge[] = {
 	{"always",	SHMEM_HUGE_ALWAYS },
 	{"within_size",	SHMEM_HUGE_WITHIN_SIZE },
 	{"advise",	SHMEM_HUGE_ADVISE },
+	{"adaptive",	SHMEM_HUGE_ADAPTIVE },
 	{}
 };
 
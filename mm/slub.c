@@ -371,6 +371,10 @@ enum stat_item {
 	CPU_PARTIAL_FREE,	/* Refill cpu partial on free */
 	CPU_PARTIAL_NODE,	/* Refill cpu partial from node partial */
 	CPU_PARTIAL_DRAIN,	/* Drain cpu partial to node partial */
+	ALLOC_PCA,		/* Allocation from the per cpu array */
+	FREE_PCA,		/* Free to the per cpu array */
+	PCA_REFILL,		/* Per cpu array refilled from slabs */
+	PCA_FLUSH,		/* Per cpu array flushed to slabs */
 	NR_SLUB_STAT_ITEMS
 };
 
@@ -396,6 +400,46 @@ struct kmem_cache_cpu {
 	unsigned int stat[NR_SLUB_STAT_ITEMS];
 #endif
 };
+
+/*
+ * Per cpu array of free objects for caches created with SLAB_PERCPU_ARRAY.
+ * Objects in the array have gone through the free hooks and are handed out
+ * again through the alloc hooks, they are not on any slab freelist.
+ */
+struct slub_percpu_array {
+	local_lock_t lock;	/* Protects the fields below */
+	unsigned int count;	/* Number of cached objects */
+	void *objects[];
+};
+
+/* Number of objects moved between the array and the slabs at a time */
+#define SLUB_PCA_BATCH	16
+
+static void *alloc_from_pca(struct kmem_cache *s, gfp_t gfp);
+static bool free_to_pca(struct kmem_cache *s, struct slab *slab, void *object);
+static void flush_pca(struct kmem_cache *s);
+static void flush_pca_cpu(struct kmem_cache *s, int cpu);
+
+static __always_inline bool slab_has_pca(struct kmem_cache *s)
+{
+	return s->cpu_array != NULL;
+}
+#else
+static inline void *alloc_from_pca(struct kmem_cache *s, gfp_t gfp)
+{
+	return NULL;
+}
+
+static inline bool free_to_pca(struct kmem_cache *s, struct slab *slab,
+			       void *object)
+{
+	return false;
+}
+
+static __always_inline bool slab_has_pca(struct kmem_cache *s)
+{
+	return false;
+}
 #endif /* CONFIG_SLUB_TINY */
 
 static inline void stat(const struct kmem_cache *s, enum stat_item si)
@@ -3281,6 +3325,9 @@ static inline void __flush_cpu_slab(struct kmem_cache *s, int cpu)
 	}
 
 	put_partials_cpu(s, c);
+
+	if (s->cpu_array)
+		flush_pca_cpu(s, cpu);
 }
 
 struct slub_flush_work {
@@ -3305,6 +3352,9 @@ static void flush_cpu_slab(struct work_struct *w)
 	s = sfw->s;
 	c = this_cpu_ptr(s->cpu_slab);
 
+	if (s->cpu_array)
+		flush_pca(s);
+
 	if (c->slab)
 		flush_slab(s, c);
 
@@ -3315,6 +3365,9 @@ static bool has_cpu_slab(int cpu, struct kmem_cache *s)
 {
 	struct kmem_cache_cpu *c = per_cpu_ptr(s->cpu_slab, cpu);
 
+	if (s->cpu_array && per_cpu_ptr(s->cpu_array, cpu)->count)
+		return true;
+
 	return c->slab || slub_percpu_partial(c);
 }
 
@@ -4153,7 +4206,11 @@ static __fastpath_inline void *slab_alloc_node(struct kmem_cache *s, struct list
 	if (unlikely(object))
 		goto out;
 
-	object = __slab_alloc_node(s, gfpflags, node, addr, orig_size);
+	object = NULL;
+	if (slab_has_pca(s) && node == NUMA_NO_NODE)
+		object = alloc_from_pca(s, gfpflags);
+	if (!object)
+		object = __slab_alloc_node(s, gfpflags, node, addr, orig_size);
 
 	maybe_wipe_obj_freeptr(s, object);
 	init = slab_want_init_on_alloc(gfpflags, s);
@@ -4610,8 +4667,13 @@ void slab_free(struct kmem_cache *s, struct slab *slab, void *object,
 	memcg_slab_free_hook(s, slab, &object, 1);
 	alloc_tagging_slab_free_hook(s, slab, &object, 1);
 
-	if (likely(slab_free_hook(s, object, slab_want_init_on_free(s), false)))
-		do_slab_free(s, slab, object, object, 1, addr);
+	if (unlikely(!slab_free_hook(s, object, slab_want_init_on_free(s), false)))
+		return;
+
+	if (slab_has_pca(s) && free_to_pca(s, slab, object))
+		return;
+
+	do_slab_free(s, slab, object, object, 1, addr);
 }
 
 #ifdef CONFIG_MEMCG
@@ -5134,6 +5196,148 @@ int kmem_cache_alloc_bulk_noprof(struct kmem_cache *s, gfp_t flags, size_t size,
 }
 EXPORT_SYMBOL(kmem_cache_alloc_bulk_noprof);
 
+#ifndef CONFIG_SLUB_TINY
+/*
+ * Refill the per cpu array with a batch of objects from the slabs. The bulk
+ * allocation may enable interrupts to allocate a new slab, so it is done
+ * outside of the array lock and the objects are copied in afterwards. Any
+ * objects that no longer fit because of a concurrent refill on this cpu are
+ * returned to the slabs.
+ */
+static bool refill_pca(struct kmem_cache *s, gfp_t gfp)
+{
+	void *objects[SLUB_PCA_BATCH];
+	struct slub_percpu_array *pca;
+	unsigned int batch, filled;
+	unsigned long flags;
+
+	batch = min_t(unsigned int, SLUB_PCA_BATCH, s->cpu_array_size / 2);
+	if (!__kmem_cache_alloc_bulk(s, gfp, batch, objects))
+		return false;
+
+	local_lock_irqsave(&s->cpu_array->lock, flags);
+	pca = this_cpu_ptr(s->cpu_array);
+	filled = min(batch, s->cpu_array_size - pca->count);
+	memcpy(&pca->objects[pca->count], objects, filled * sizeof(void *));
+	pca->count += filled;
+	local_unlock_irqrestore(&s->cpu_array->lock, flags);
+
+	stat(s, PCA_REFILL);
+	if (filled < batch)
+		__kmem_cache_free_bulk(s, batch - filled, &objects[filled]);
+
+	return true;
+}
+
+/*
+ * Returns NULL when the array could not supply an object, in which case the
+ * caller falls back to the regular slab allocation path.
+ */
+static void *alloc_from_pca(struct kmem_cache *s, gfp_t gfp)
+{
+	struct slub_percpu_array *pca;
+	unsigned long flags;
+	void *object;
+
+	local_lock_irqsave(&s->cpu_array->lock, flags);
+	pca = this_cpu_ptr(s->cpu_array);
+
+	if (unlikely(!pca->count)) {
+		local_unlock_irqrestore(&s->cpu_array->lock, flags);
+
+		if (!refill_pca(s, gfp))
+			return NULL;
+
+		local_lock_irqsave(&s->cpu_array->lock, flags);
+		pca = this_cpu_ptr(s->cpu_array);
+		if (unlikely(!pca->count)) {
+			local_unlock_irqrestore(&s->cpu_array->lock, flags);
+			return NULL;
+		}
+	}
+
+	object = pca->objects[--pca->count];
+	local_unlock_irqrestore(&s->cpu_array->lock, flags);
+	stat(s, ALLOC_PCA);
+
+	return object;
+}
+
+/*
+ * Objects from a remote node are freed directly to their slab so that the
+ * array only hands out node local objects. When the array is full, the
+ * oldest batch of objects is flushed to the slabs to make room.
+ */
+static bool free_to_pca(struct kmem_cache *s, struct slab *slab, void *object)
+{
+	void *objects[SLUB_PCA_BATCH];
+	struct slub_percpu_array *pca;
+	unsigned int batch = 0;
+	unsigned long flags;
+
+	if (is_kfence_address(object))
+		return false;
+
+	if (IS_ENABLED(CONFIG_NUMA) && slab_nid(slab) != numa_mem_id())
+		return false;
+
+	local_lock_irqsave(&s->cpu_array->lock, flags);
+	pca = this_cpu_ptr(s->cpu_array);
+
+	if (unlikely(pca->count == s->cpu_array_size)) {
+		batch = min_t(unsigned int, SLUB_PCA_BATCH, pca->count);
+		memcpy(objects, pca->objects, batch * sizeof(void *));
+		pca->count -= batch;
+		memmove(pca->objects, &pca->objects[batch],
+			pca->count * sizeof(void *));
+	}
+
+	pca->objects[pca->count++] = object;
+	local_unlock_irqrestore(&s->cpu_array->lock, flags);
+	stat(s, FREE_PCA);
+
+	if (batch) {
+		__kmem_cache_free_bulk(s, batch, objects);
+		stat(s, PCA_FLUSH);
+	}
+
+	return true;
+}
+
+/* Flush the array of the current cpu, from the cpu flush work. */
+static void flush_pca(struct kmem_cache *s)
+{
+	void *objects[SLUB_PCA_BATCH];
+	struct slub_percpu_array *pca;
+	unsigned long flags;
+	unsigned int batch;
+
+	do {
+		local_lock_irqsave(&s->cpu_array->lock, flags);
+		pca = this_cpu_ptr(s->cpu_array);
+		batch = min_t(unsigned int, SLUB_PCA_BATCH, pca->count);
+		pca->count -= batch;
+		memcpy(objects, &pca->objects[pca->count],
+		       batch * sizeof(void *));
+		local_unlock_irqrestore(&s->cpu_array->lock, flags);
+
+		if (batch) {
+			__kmem_cache_free_bulk(s, batch, objects);
+			stat(s, PCA_FLUSH);
+		}
+	} while (batch);
+}
+
+/* Flush the array of an offlined cpu, nothing else can access it. */
+static void flush_pca_cpu(struct kmem_cache *s, int cpu)
+{
+	struct slub_percpu_array *pca = per_cpu_ptr(s->cpu_array, cpu);
+
+	__kmem_cache_free_bulk(s, pca->count, pca->objects);
+	pca->count = 0;
+}
+#endif /* CONFIG_SLUB_TINY */
+
 
 /*
  * Object placement in a slab is made very easy because we always start at
@@ -5281,6 +5485,42 @@ init_kmem_cache_node(struct kmem_cache_node *n)
 }
 
 #ifndef CONFIG_SLUB_TINY
+/*
+ * The array should absorb a typical burst of frees without flushing, but
+ * caching many large objects per cpu would waste too much memory.
+ */
+static unsigned int calculate_cpu_array_size(struct kmem_cache *s)
+{
+	if (s->size >= PAGE_SIZE)
+		return 16;
+	if (s->size >= 1024)
+		return 32;
+	if (s->size >= 256)
+		return 64;
+	return 128;
+}
+
+static int alloc_kmem_cache_pca(struct kmem_cache *s)
+{
+	int cpu;
+
+	s->cpu_array_size = calculate_cpu_array_size(s);
+	s->cpu_array = __alloc_percpu(struct_size_t(struct slub_percpu_array,
+						    objects, s->cpu_array_size),
+				      sizeof(void *));
+	if (!s->cpu_array)
+		return 0;
+
+	for_each_possible_cpu(cpu) {
+		struct slub_percpu_array *pca = per_cpu_ptr(s->cpu_array, cpu);
+
+		local_lock_init(&pca->lock);
+		pca->count = 0;
+	}
+
+	return 1;
+}
+
 static inline int alloc_kmem_cache_cpus(struct kmem_cache *s)
 {
 	BUILD_BUG_ON(PERCPU_DYNAMIC_EARLY_SIZE <
@@ -5299,6 +5539,10 @@ static inline int alloc_kmem_cache_cpus(struct kmem_cache *s)
 
 	init_kmem_cache_cpus(s);
 
+	/* The array would hide objects from the debugging checks */
+	if ((s->flags & SLAB_PERCPU_ARRAY) && !kmem_cache_debug(s))
+		return alloc_kmem_cache_pca(s);
+
 	return 1;
 }
 #else
@@ -5368,6 +5612,7 @@ void __kmem_cache_release(struct kmem_cache *s)
 {
 	cache_random_seq_destroy(s);
 #ifndef CONFIG_SLUB_TINY
+	free_percpu(s->cpu_array);
 	free_percpu(s->cpu_slab);
 #endif
 	free_kmem_cache_nodes(s);
@@ -7039,6 +7284,10 @@ STAT_ATTR(CPU_PARTIAL_ALLOC, cpu_partial_alloc);
 STAT_ATTR(CPU_PARTIAL_FREE, cpu_partial_free);
 STAT_ATTR(CPU_PARTIAL_NODE, cpu_partial_node);
 STAT_ATTR(CPU_PARTIAL_DRAIN, cpu_partial_drain);
+STAT_ATTR(ALLOC_PCA, alloc_pca);
+STAT_ATTR(FREE_PCA, free_pca);
+STAT_ATTR(PCA_REFILL, pca_refill);
+STAT_ATTR(PCA_FLUSH, pca_flush);
 #endif	/* CONFIG_SLUB_STATS */
 
 #ifdef CONFIG_KFENCE
@@ -7126,6 +7375,10 @@ static struct attribute *slab_attrs[] = {
 	&cpu_partial_free_attr.attr,
 	&cpu_partial_node_attr.attr,
 	&cpu_partial_drain_attr.attr,
+	&alloc_pca_attr.attr,
+	&free_pca_attr.attr,
+	&pca_refill_attr.attr,
+	&pca_flush_attr.attr,
 #endif
 #ifdef CONFIG_FAILSLAB
 	&failslab_attr.attr,
@@ -719,6 +719,8 @@ int init_swap_address_space(unsigned int type, unsigned long nr_pages)
 	for (i = 0; i < nr; i++) {
 		space = spaces + i;
 		xa_init_flags(&space->i_pages, XA_FLAGS_LOCK_IRQ);
+		seqcount_spinlock_init(&space->i_pages_delete_seqcnt,
+				       &space->i_pages.xa_lock);
 		atomic_set(&space->i_mmap_writable, 0);
 		space->a_ops = &swap_aops;
 		/* swap cache doesn't use writeback related tags */
@@ -382,6 +382,9 @@ static void discard_swap_cluster(struct swap_info_struct *si,
 #endif
 #define LATENCY_LIMIT		256
 
+/* Max number of fragmented clusters the defrag worker looks at per run */
+#define SWAP_DEFRAG_BATCH	64
+
 static inline bool cluster_is_free(struct swap_cluster_info *info)
 {
 	return info->flags & CLUSTER_FLAG_FREE;
@@ -788,6 +791,74 @@ static void swap_reclaim_work(struct work_struct *work)
 	spin_unlock(&si->lock);
 }
 
+/*
+ * Try to turn a fragmented cluster back into a free one by dropping the swap
+ * cache of slots that are held only by it. Clusters with any slot still in
+ * use by a swap entry are left alone since they can't become free anyway.
+ */
+static void swap_defrag_cluster(struct swap_info_struct *si,
+				struct swap_cluster_info *ci)
+{
+	unsigned long offset = cluster_offset(si, ci);
+	unsigned long end = min(si->max, offset + SWAPFILE_CLUSTER);
+	unsigned char *map = si->swap_map;
+	unsigned long i;
+	int nr_reclaim;
+
+	for (i = offset; i < end; i++) {
+		unsigned char count = READ_ONCE(map[i]);
+
+		if (count && count != SWAP_HAS_CACHE)
+			return;
+	}
+
+	spin_unlock(&si->lock);
+	while (offset < end) {
+		if (READ_ONCE(map[offset]) == SWAP_HAS_CACHE) {
+			nr_reclaim = __try_to_reclaim_swap(si, offset,
+							   TTRS_ANYWAY | TTRS_DIRECT);
+			if (nr_reclaim) {
+				offset += abs(nr_reclaim);
+				continue;
+			}
+		}
+		offset++;
+	}
+	spin_lock(&si->lock);
+}
+
+/*
+ * Large folio allocations can only be served from free clusters or from
+ * nonfull clusters of their own order. Once those run out, a swap device full
+ * of partly used clusters forces every large folio to be split on swapout,
+ * even though many of those clusters hold nothing but swap cache. Reclaim
+ * such clusters in the background so that they become free again.
+ */
+static void swap_defrag_work(struct work_struct *work)
+{
+	struct swap_info_struct *si;
+	struct swap_cluster_info *ci;
+	long to_scan = SWAP_DEFRAG_BATCH;
+	unsigned int nr;
+	int o;
+
+	si = container_of(work, struct swap_info_struct, defrag_work);
+
+	spin_lock(&si->lock);
+	for (o = 0; o < SWAP_NR_ORDERS && to_scan > 0; o++) {
+		nr = si->frag_cluster_nr[o];
+		while (nr-- && to_scan-- > 0 &&
+		       !list_empty(&si->frag_clusters[o]) &&
+		       list_empty(&si->free_clusters)) {
+			ci = list_first_entry(&si->frag_clusters[o],
+					      struct swap_cluster_info, list);
+			list_move_tail(&ci->list, &si->frag_clusters[o]);
+			swap_defrag_cluster(si, ci);
+		}
+	}
+	spin_unlock(&si->lock);
+}
+
 /*
  * Try to get swap entries with specified order from current cpu's swap entry
  * pool (a cluster). This might involve allocating a new cluster for current CPU
@@ -877,8 +948,11 @@ static unsigned long cluster_alloc_swap_entry(struct swap_info_struct *si, int o
 		goto new_cluster;
 	}
 
-	if (order)
+	if (order) {
+		if (si->flags & SWP_WRITEOK)
+			schedule_work(&si->defrag_work);
 		goto done;
+	}
 
 	/* Order 0 stealing from higher order */
 	for (int o = 1; o < SWAP_NR_ORDERS; o++) {
@@ -2842,6 +2916,7 @@ SYSCALL_DEFINE1(swapoff, const char __user *, specialfile)
 
 	flush_work(&p->discard_work);
 	flush_work(&p->reclaim_work);
+	flush_work(&p->defrag_work);
 
 	destroy_swap_extents(p);
 	if (p->flags & SWP_CONTINUED)
@@ -3403,6 +3478,7 @@ SYSCALL_DEFINE2(swapon, const char __user *, specialfile, int, swap_flags)
 
 	INIT_WORK(&si->discard_work, swap_discard_work);
 	INIT_WORK(&si->reclaim_work, swap_reclaim_work);
+	INIT_WORK(&si->defrag_work, swap_defrag_work);
 
 	name = getname(specialfile);
 	if (IS_ERR(name)) {
@@ -1935,6 +1935,83 @@ node_alloc(unsigned long size, unsigned long align,
 	return va;
 }
 
+/*
+ * When a node's pool has nothing of the requested size, carve this many
+ * extra VAs of that size from the global heap under the same lock and put
+ * them into the pool. Repeated users of one size, such as stacks or BPF
+ * programs, then allocate from their node for a while instead of taking
+ * free_vmap_area_lock every time. Unused ones are returned to the global
+ * heap by the regular pool decay on purge.
+ */
+#define VMAP_POOL_PREFILL 4
+
+static int
+node_pool_prealloc(struct vmap_area **vas, unsigned long size,
+		unsigned int vn_id, gfp_t gfp_mask, int node)
+{
+	int i;
+
+	if (!is_vn_id_valid(decode_vn_id(vn_id)) ||
+			!size_to_va_pool(id_to_node(decode_vn_id(vn_id)), size))
+		return 0;
+
+	for (i = 0; i < VMAP_POOL_PREFILL; i++) {
+		vas[i] = kmem_cache_alloc_node(vmap_area_cachep,
+			gfp_mask | __GFP_NOWARN, node);
+		if (!vas[i])
+			break;
+
+		kmemleak_scan_area(&vas[i]->rb_node, SIZE_MAX, gfp_mask);
+	}
+
+	return i;
+}
+
+/* Must be called with free_vmap_area_lock held. */
+static int
+node_pool_carve(struct vmap_area **vas, int nr, unsigned long size,
+		unsigned long align, unsigned long vstart, unsigned long vend)
+{
+	unsigned long addr;
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		/*
+		 * Only carve while a split, if one is needed, can be served
+		 * from the preloaded node. Prefilling is best effort and must
+		 * not trip the GFP_NOWAIT fallback in va_clip().
+		 */
+		if (!this_cpu_read(ne_fit_preload_node))
+			break;
+
+		addr = __alloc_vmap_area(&free_vmap_area_root, &free_vmap_area_list,
+			size, align, vstart, vend);
+		if (addr == vend)
+			break;
+
+		vas[i]->va_start = addr;
+		vas[i]->va_end = addr + size;
+		vas[i]->vm = NULL;
+	}
+
+	return i;
+}
+
+static void
+node_pool_attach(struct vmap_area **vas, int nr, int nr_carved,
+		unsigned int vn_id)
+{
+	struct vmap_node *vn = id_to_node(decode_vn_id(vn_id));
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		if (i < nr_carved && node_pool_add_va(vn, vas[i]))
+			continue;
+
+		kmem_cache_free(vmap_area_cachep, vas[i]);
+	}
+}
+
 static inline void setup_vmalloc_vm(struct vm_struct *vm,
 	struct vmap_area *va, unsigned long flags, const void *caller)
 {
@@ -1955,6 +2032,8 @@ static struct vmap_area *alloc_vmap_area(unsigned long size,
 				int node, gfp_t gfp_mask,
 				unsigned long va_flags, struct vm_struct *vm)
 {
+	struct vmap_area *prefill[VMAP_POOL_PREFILL];
+	int nr_prefill = 0, nr_carved = 0;
 	struct vmap_node *vn;
 	struct vmap_area *va;
 	unsigned long freed;
@@ -1992,6 +2071,9 @@ static struct vmap_area *alloc_vmap_area(unsigned long size,
 		 * to avoid false negatives.
 		 */
 		kmemleak_scan_area(&va->rb_node, SIZE_MAX, gfp_mask);
+
+		nr_prefill = node_pool_prealloc(prefill, size, vn_id,
+			gfp_mask, node);
 	}
 
 retry:
@@ -1999,9 +2081,17 @@ static struct vmap_area *alloc_vmap_area(unsigned long size,
 		preload_this_cpu_lock(&free_vmap_area_lock, gfp_mask, node);
 		addr = __alloc_vmap_area(&free_vmap_area_root, &free_vmap_area_list,
 			size, align, vstart, vend);
+		if (addr != vend && nr_prefill)
+			nr_carved = node_pool_carve(prefill, nr_prefill,
+				size, align, vstart, vend);
 		spin_unlock(&free_vmap_area_lock);
 	}
 
+	if (nr_prefill) {
+		node_pool_attach(prefill, nr_prefill, nr_carved, vn_id);
+		nr_prefill = 0;
+	}
+
 	trace_alloc_vmap_area(addr, size, align, vstart, vend, addr == vend);
 
 	/*
@@ -1043,6 +1043,86 @@ static bool may_enter_fs(struct folio *folio, gfp_t gfp_mask)
 	return !data_race(folio_swap_flags(folio) & SWP_FS_OPS);
 }
 
+/*
+ * Maximum number of dirty folios shrink_folio_list() holds locked while
+ * deferring their pageout to batch TLB flushes.
+ */
+#define PAGEOUT_BATCH		SWAP_CLUSTER_MAX
+
+static void folio_activate_locked(struct folio *folio, unsigned int nr_pages,
+		struct reclaim_stat *stat)
+{
+	/* Not a candidate for swapping, so reclaim swap space. */
+	if (folio_test_swapcache(folio) &&
+	    (mem_cgroup_swap_full(folio) || folio_test_mlocked(folio)))
+		folio_free_swap(folio);
+	VM_BUG_ON_FOLIO(folio_test_active(folio), folio);
+	if (!folio_test_mlocked(folio)) {
+		int type = folio_is_file_lru(folio);
+		folio_set_active(folio);
+		stat->nr_activate[type] += nr_pages;
+		count_memcg_folio_events(folio, PGACTIVATE, nr_pages);
+	}
+}
+
+/*
+ * Write out the dirty folios collected by shrink_folio_list().  They have all
+ * been unmapped with their TLB flushes deferred, so a single flush covers the
+ * whole batch instead of one flush per folio.  Folios that are clean once
+ * pageout() returns, e.g. because they were written synchronously to zram,
+ * are put back on @folio_list to be freed, all others go to @ret_folios.
+ */
+static void pageout_folio_list(struct list_head *pageout_folios,
+		struct list_head *folio_list, struct list_head *ret_folios,
+		struct swap_iocb **plug, struct scan_control *sc,
+		struct reclaim_stat *stat)
+{
+	try_to_unmap_flush_dirty();
+
+	while (!list_empty(pageout_folios)) {
+		struct folio *folio = lru_to_folio(pageout_folios);
+		unsigned int nr_pages = folio_nr_pages(folio);
+		pageout_t ret;
+
+		list_del(&folio->lru);
+		ret = pageout(folio, folio_mapping(folio), plug, folio_list);
+
+		/* A split shmem folio's tails get their own pass. */
+		if (nr_pages > 1 && !folio_test_large(folio)) {
+			sc->nr_scanned -= (nr_pages - 1);
+			nr_pages = 1;
+		}
+
+		switch (ret) {
+		case PAGE_KEEP:
+			folio_unlock(folio);
+			break;
+		case PAGE_ACTIVATE:
+			folio_activate_locked(folio, nr_pages, stat);
+			folio_unlock(folio);
+			break;
+		case PAGE_SUCCESS:
+			stat->nr_pageout += nr_pages;
+			if (folio_test_writeback(folio) ||
+			    folio_test_dirty(folio))
+				break;
+			/*
+			 * A synchronous write - probably a ramdisk.  Go
+			 * ahead and try to reclaim the folio.
+			 */
+			sc->nr_scanned -= nr_pages;
+			list_add(&folio->lru, folio_list);
+			continue;
+		case PAGE_CLEAN:
+			folio_unlock(folio);
+			sc->nr_scanned -= nr_pages;
+			list_add(&folio->lru, folio_list);
+			continue;
+		}
+		list_add(&folio->lru, ret_folios);
+	}
+}
+
 /*
  * shrink_folio_list() returns the number of reclaimed pages
  */
@@ -1053,9 +1133,12 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 	struct folio_batch free_folios;
 	LIST_HEAD(ret_folios);
 	LIST_HEAD(demote_folios);
+	LIST_HEAD(pageout_folios);
 	unsigned int nr_reclaimed = 0;
 	unsigned int pgactivate = 0;
+	unsigned int nr_pageout_folios = 0;
 	bool do_demote_pass;
+	bool defer_pageout = true;
 	struct swap_iocb *plug = NULL;
 
 	folio_batch_init(&free_folios);
@@ -1366,10 +1449,24 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 				goto keep_locked;
 
 			/*
-			 * Folio is dirty. Flush the TLB if a writable entry
-			 * potentially exists to avoid CPU writes after I/O
-			 * starts and then write it out here.
+			 * Folio is dirty. The TLB must be flushed if a
+			 * writable entry potentially exists to avoid CPU
+			 * writes after I/O starts.  Collect dirty folios so
+			 * that one flush covers a batch of them, and write
+			 * them out afterwards.
 			 */
+			if (defer_pageout) {
+				list_add(&folio->lru, &pageout_folios);
+				if (++nr_pageout_folios >= PAGEOUT_BATCH) {
+					pageout_folio_list(&pageout_folios,
+							   folio_list,
+							   &ret_folios, &plug,
+							   sc, stat);
+					nr_pageout_folios = 0;
+				}
+				continue;
+			}
+
 			try_to_unmap_flush_dirty();
 			switch (pageout(folio, mapping, &plug, folio_list)) {
 			case PAGE_KEEP:
@@ -1501,17 +1598,7 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 			nr_pages = 1;
 		}
 activate_locked:
-		/* Not a candidate for swapping, so reclaim swap space. */
-		if (folio_test_swapcache(folio) &&
-		    (mem_cgroup_swap_full(folio) || folio_test_mlocked(folio)))
-			folio_free_swap(folio);
-		VM_BUG_ON_FOLIO(folio_test_active(folio), folio);
-		if (!folio_test_mlocked(folio)) {
-			int type = folio_is_file_lru(folio);
-			folio_set_active(folio);
-			stat->nr_activate[type] += nr_pages;
-			count_memcg_folio_events(folio, PGACTIVATE, nr_pages);
-		}
+		folio_activate_locked(folio, nr_pages, stat);
 keep_locked:
 		folio_unlock(folio);
 keep:
@@ -1519,6 +1606,20 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 		VM_BUG_ON_FOLIO(folio_test_lru(folio) ||
 				folio_test_unevictable(folio), folio);
 	}
+
+	if (!list_empty(&pageout_folios)) {
+		pageout_folio_list(&pageout_folios, folio_list, &ret_folios,
+				   &plug, sc, stat);
+		nr_pageout_folios = 0;
+		/*
+		 * Free the folios that were written synchronously.  Should
+		 * they have been dirtied again, write them out directly.
+		 */
+		if (!list_empty(folio_list)) {
+			defer_pageout = false;
+			goto retry;
+		}
+	}
 	/* 'folio_list' is always empty here */
 
 	/* Migrate folios selected for demotion */
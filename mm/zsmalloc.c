@@ -148,6 +148,16 @@
 #define ZS_SIZE_CLASSES	(DIV_ROUND_UP(ZS_MAX_ALLOC_SIZE - ZS_MIN_ALLOC_SIZE, \
 				      ZS_SIZE_CLASS_DELTA) + 1)
 
+/*
+ * zs_free() kicks background compaction once a class has at least
+ * ZS_BG_COMPACT_MIN_PAGES pages worth of unused objects and those make
+ * up at least 1/ZS_BG_COMPACT_RATIO of the pages held by the class.
+ * Background runs are spaced at least ZS_BG_COMPACT_INTERVAL apart.
+ */
+#define ZS_BG_COMPACT_MIN_PAGES	64
+#define ZS_BG_COMPACT_RATIO	4
+#define ZS_BG_COMPACT_INTERVAL	HZ
+
 /*
  * Pages are distinguished by the ratio of used memory (that is the ratio
  * of ->inuse objects to all objects that page can store). For example,
@@ -243,6 +253,10 @@ struct zs_pool {
 	/* protect page/zspage migration */
 	rwlock_t migrate_lock;
 	atomic_t compaction_in_progress;
+
+	/* Fragmentation driven background compaction */
+	struct work_struct compact_work;
+	unsigned long next_bg_compact;
 };
 
 struct zspage {
@@ -294,6 +308,8 @@ static void init_deferred_free(struct zs_pool *pool) {}
 static void SetZsPageMovable(struct zs_pool *pool, struct zspage *zspage) {}
 #endif
 
+static void kick_bg_compact(struct zs_pool *pool, struct size_class *class);
+
 static int create_cache(struct zs_pool *pool)
 {
 	char *name;
@@ -1454,6 +1470,8 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 	fullness = fix_fullness_group(class, zspage);
 	if (fullness == ZS_INUSE_RATIO_0)
 		free_zspage(pool, class, zspage);
+	else
+		kick_bg_compact(pool, class);
 
 	spin_unlock(&class->lock);
 	cache_free_handle(pool, handle);
@@ -1991,7 +2009,39 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 	return pages_freed;
 }
 
-unsigned long zs_compact(struct zs_pool *pool)
+/*
+ * A class is considered fragmented when a sizeable number of its pages
+ * could be released by compaction, both in absolute terms and relative to
+ * the size of the class. Called with class->lock held.
+ */
+static bool zs_class_fragmented(struct size_class *class)
+{
+	unsigned long wasted = zs_can_compact(class);
+	unsigned long total;
+
+	if (wasted < ZS_BG_COMPACT_MIN_PAGES)
+		return false;
+
+	total = class_stat_read(class, ZS_OBJS_ALLOCATED) /
+		class->objs_per_zspage * class->pages_per_zspage;
+
+	return wasted * ZS_BG_COMPACT_RATIO >= total;
+}
+
+static void kick_bg_compact(struct zs_pool *pool, struct size_class *class)
+{
+	if (time_before(jiffies, READ_ONCE(pool->next_bg_compact)))
+		return;
+
+	if (!zs_class_fragmented(class))
+		return;
+
+	WRITE_ONCE(pool->next_bg_compact, jiffies + ZS_BG_COMPACT_INTERVAL);
+	queue_work(system_unbound_wq, &pool->compact_work);
+}
+
+static unsigned long zs_compact_classes(struct zs_pool *pool,
+					bool fragmented_only)
 {
 	int i;
 	struct size_class *class;
@@ -2007,18 +2057,47 @@ unsigned long zs_compact(struct zs_pool *pool)
 		return 0;
 
 	for (i = ZS_SIZE_CLASSES - 1; i >= 0; i--) {
+		bool skip = false;
+
 		class = pool->size_class[i];
 		if (class->index != i)
 			continue;
-		pages_freed += __zs_compact(pool, class);
+
+		/*
+		 * Background compaction only touches the classes that are
+		 * worth it, so that the pool-wide migrate_lock is not taken
+		 * for classes where there is little to gain.
+		 */
+		if (fragmented_only) {
+			spin_lock(&class->lock);
+			skip = !zs_class_fragmented(class);
+			spin_unlock(&class->lock);
+		}
+
+		if (!skip)
+			pages_freed += __zs_compact(pool, class);
+		cond_resched();
 	}
 	atomic_long_add(pages_freed, &pool->stats.pages_compacted);
 	atomic_set(&pool->compaction_in_progress, 0);
 
 	return pages_freed;
 }
+
+unsigned long zs_compact(struct zs_pool *pool)
+{
+	return zs_compact_classes(pool, false);
+}
 EXPORT_SYMBOL_GPL(zs_compact);
 
+static void zs_bg_compact(struct work_struct *work)
+{
+	struct zs_pool *pool = container_of(work, struct zs_pool,
+					    compact_work);
+
+	zs_compact_classes(pool, true);
+}
+
 void zs_pool_stats(struct zs_pool *pool, struct zs_pool_stats *stats)
 {
 	memcpy(stats, &pool->stats, sizeof(struct zs_pool_stats));
@@ -2125,6 +2204,8 @@ struct zs_pool *zs_create_pool(const char *name)
 	init_deferred_free(pool);
 	rwlock_init(&pool->migrate_lock);
 	atomic_set(&pool->compaction_in_progress, 0);
+	INIT_WORK(&pool->compact_work, zs_bg_compact);
+	pool->next_bg_compact = jiffies;
 
 	pool->name = kstrdup(name, GFP_KERNEL);
 	if (!pool->name)
@@ -2231,6 +2312,7 @@ void zs_destroy_pool(struct zs_pool *pool)
 	int i;
 
 	zs_unregister_shrinker(pool);
+	cancel_work_sync(&pool->compact_work);
 	zs_flush_migration(pool);
 	zs_pool_stat_destroy(pool);
 
@@ -921,10 +921,15 @@ static void acomp_ctx_put_unlock(struct crypto_acomp_ctx *acomp_ctx)
 	mutex_unlock(&acomp_ctx->mutex);
 }
 
+/*
+ * Compress @page into @entry. The caller holds @acomp_ctx, which lets a
+ * batch of pages be compressed under one acquisition of the per-CPU
+ * context instead of bouncing the mutex for every page.
+ */
 static bool zswap_compress(struct page *page, struct zswap_entry *entry,
-			   struct zswap_pool *pool)
+			   struct zswap_pool *pool,
+			   struct crypto_acomp_ctx *acomp_ctx)
 {
-	struct crypto_acomp_ctx *acomp_ctx;
 	struct scatterlist input, output;
 	int comp_ret = 0, alloc_ret = 0;
 	unsigned int dlen = PAGE_SIZE;
@@ -934,7 +939,6 @@ static bool zswap_compress(struct page *page, struct zswap_entry *entry,
 	gfp_t gfp;
 	u8 *dst;
 
-	acomp_ctx = acomp_ctx_get_cpu_lock(pool);
 	dst = acomp_ctx->buffer;
 	sg_init_table(&input, 1);
 	sg_set_page(&input, page, PAGE_SIZE, 0);
@@ -987,7 +991,6 @@ static bool zswap_compress(struct page *page, struct zswap_entry *entry,
 	else if (alloc_ret)
 		zswap_reject_alloc_fail++;
 
-	acomp_ctx_put_unlock(acomp_ctx);
 	return comp_ret == 0 && alloc_ret == 0;
 }
 
@@ -1445,22 +1448,21 @@ static void shrink_worker(struct work_struct *w)
 * main API
 **********************************/
 
-static ssize_t zswap_store_page(struct page *page,
-				struct obj_cgroup *objcg,
-				struct zswap_pool *pool)
+/*
+ * Number of pages of a large folio that are compressed under a single
+ * acquisition of the per-CPU acomp context. The entries for a batch are
+ * allocated up front and inserted into the tree after the context has been
+ * released, because the xarray allocation may enter direct reclaim and
+ * recurse into zswap_store() on the same CPU.
+ */
+#define ZSWAP_STORE_BATCH	8
+
+static ssize_t zswap_store_entry(struct zswap_entry *entry, struct page *page,
+				 struct obj_cgroup *objcg,
+				 struct zswap_pool *pool)
 {
 	swp_entry_t page_swpentry = page_swap_entry(page);
-	struct zswap_entry *entry, *old;
-
-	/* allocate entry */
-	entry = zswap_entry_cache_alloc(GFP_KERNEL, page_to_nid(page));
-	if (!entry) {
-		zswap_reject_kmemcache_fail++;
-		return -EINVAL;
-	}
-
-	if (!zswap_compress(page, entry, pool))
-		goto compress_failed;
+	struct zswap_entry *old;
 
 	old = xa_store(swap_zswap_tree(page_swpentry),
 		       swp_offset(page_swpentry),
@@ -1470,7 +1472,7 @@ static ssize_t zswap_store_page(struct page *page,
 
 		WARN_ONCE(err != -ENOMEM, "unexpected xarray error: %d\n", err);
 		zswap_reject_alloc_fail++;
-		goto store_failed;
+		return -EINVAL;
 	}
 
 	/*
@@ -1511,11 +1513,65 @@ static ssize_t zswap_store_page(struct page *page,
 	}
 
 	return entry->length;
+}
 
-store_failed:
-	zpool_free(pool->zpool, entry->handle);
-compress_failed:
-	zswap_entry_cache_free(entry);
+/*
+ * Store @nr pages of @folio starting at @start, where @nr is at most
+ * ZSWAP_STORE_BATCH. Returns the number of compressed bytes stored, or a
+ * negative value on failure. Entries that made it into the tree before a
+ * failure are cleaned up by the caller.
+ */
+static ssize_t zswap_store_pages(struct folio *folio, long start, long nr,
+				 struct obj_cgroup *objcg,
+				 struct zswap_pool *pool)
+{
+	struct zswap_entry *entries[ZSWAP_STORE_BATCH];
+	struct crypto_acomp_ctx *acomp_ctx;
+	int nid = folio_nid(folio);
+	size_t compressed_bytes = 0;
+	long i, nr_compressed, nr_stored = 0;
+
+	for (i = 0; i < nr; i++) {
+		entries[i] = zswap_entry_cache_alloc(GFP_KERNEL, nid);
+		if (!entries[i]) {
+			zswap_reject_kmemcache_fail++;
+			nr = i;
+			nr_compressed = 0;
+			goto free_entries;
+		}
+	}
+
+	acomp_ctx = acomp_ctx_get_cpu_lock(pool);
+	for (nr_compressed = 0; nr_compressed < nr; nr_compressed++) {
+		struct page *page = folio_page(folio, start + nr_compressed);
+
+		if (!zswap_compress(page, entries[nr_compressed], pool,
+				    acomp_ctx))
+			break;
+	}
+	acomp_ctx_put_unlock(acomp_ctx);
+
+	if (nr_compressed < nr)
+		goto free_entries;
+
+	for (; nr_stored < nr; nr_stored++) {
+		struct page *page = folio_page(folio, start + nr_stored);
+		ssize_t bytes;
+
+		bytes = zswap_store_entry(entries[nr_stored], page, objcg, pool);
+		if (bytes < 0)
+			goto free_entries;
+		compressed_bytes += bytes;
+	}
+
+	return compressed_bytes;
+
+free_entries:
+	for (i = nr_stored; i < nr; i++) {
+		if (i < nr_compressed)
+			zpool_free(pool->zpool, entries[i]->handle);
+		zswap_entry_cache_free(entries[i]);
+	}
 	return -EINVAL;
 }
 
@@ -1562,11 +1618,11 @@ bool zswap_store(struct folio *folio)
 		mem_cgroup_put(memcg);
 	}
 
-	for (index = 0; index < nr_pages; ++index) {
-		struct page *page = folio_page(folio, index);
+	for (index = 0; index < nr_pages; index += ZSWAP_STORE_BATCH) {
+		long nr = min_t(long, nr_pages - index, ZSWAP_STORE_BATCH);
 		ssize_t bytes;
 
-		bytes = zswap_store_page(page, objcg, pool);
+		bytes = zswap_store_pages(folio, index, nr, objcg, pool);
 		if (bytes < 0)
 			goto put_pool;
 		compressed_bytes += bytes;
@@ -970,6 +970,134 @@ static void uffd_zeropage_test(uffd_test_args_t *args)
 	uffd_test_pass();
 }
 
+#define COPY_BATCH_NR	4
+
+static void *copy_batch_fault_thread(void *arg)
+{
+	char c = *(volatile char *)arg;
+
+	(void)c;
+	return NULL;
+}
+
+/* Collect @nr missing faults and return their page offsets into area_dst */
+static void copy_batch_read_faults(unsigned long *offsets, int nr)
+{
+	struct pollfd pfd = { .fd = uffd, .events = POLLIN };
+	struct uffd_msg msg;
+	int i = 0;
+
+	while (i < nr) {
+		if (poll(&pfd, 1, -1) < 0)
+			err("poll");
+		if (uffd_read_msg(uffd, &msg))
+			continue;
+		if (msg.event != UFFD_EVENT_PAGEFAULT)
+			err("unexpected msg event %u", msg.event);
+		offsets[i++] = ((char *)(unsigned long)msg.arg.pagefault.address -
+				area_dst) & ~(page_size - 1);
+	}
+}
+
+static void copy_batch_set(struct uffdio_copy *copy, unsigned long offset)
+{
+	copy->dst = (unsigned long) area_dst + offset;
+	copy->src = (unsigned long) area_src + offset;
+	copy->len = page_size;
+	copy->mode = 0;
+	copy->copy = 0;
+}
+
+/* exercise UFFDIO_COPY_BATCH */
+static void uffd_copy_batch_test(uffd_test_args_t *args)
+{
+	struct uffdio_copy copies[COPY_BATCH_NR];
+	struct uffdio_copy_batch batch = { 0 };
+	unsigned long offsets[COPY_BATCH_NR];
+	pthread_t threads[COPY_BATCH_NR];
+	unsigned long offset;
+	int i;
+
+	if (uffd_register(uffd, area_dst, nr_pages * page_size,
+			  true, false, false))
+		err("register failure");
+
+	/* Fault on every other page, so that the copies are discontiguous */
+	for (i = 0; i < COPY_BATCH_NR; i++)
+		if (pthread_create(&threads[i], NULL, copy_batch_fault_thread,
+				   area_dst + 2 * i * page_size))
+			err("pthread_create");
+
+	copy_batch_read_faults(offsets, COPY_BATCH_NR);
+
+	for (i = 0; i < COPY_BATCH_NR; i++)
+		copy_batch_set(&copies[i], offsets[i]);
+	batch.copies = (unsigned long) copies;
+	batch.nr = COPY_BATCH_NR;
+	batch.copied = -1;
+	if (ioctl(uffd, UFFDIO_COPY_BATCH, &batch))
+		err("UFFDIO_COPY_BATCH error: copied %"PRId64,
+		    (int64_t)batch.copied);
+	if (batch.copied != COPY_BATCH_NR)
+		err("UFFDIO_COPY_BATCH copied %"PRId64", expected %d",
+		    (int64_t)batch.copied, COPY_BATCH_NR);
+	for (i = 0; i < COPY_BATCH_NR; i++)
+		if (copies[i].copy != page_size)
+			err("UFFDIO_COPY_BATCH entry %d copy %"PRId64, i,
+			    (int64_t)copies[i].copy);
+
+	for (i = 0; i < COPY_BATCH_NR; i++)
+		if (pthread_join(threads[i], NULL))
+			err("pthread_join()");
+
+	for (i = 0; i < COPY_BATCH_NR; i++) {
+		offset = 2 * i * page_size;
+		if (memcmp(area_dst + offset, area_src + offset, page_size))
+			err("page %lu not copied", offset / page_size);
+	}
+
+	/*
+	 * The batch stops at the first entry that fails: the middle entry
+	 * targets a page populated above, the last one must be left alone.
+	 */
+	offset = 2 * COPY_BATCH_NR * page_size;
+	copy_batch_set(&copies[0], offset);
+	copy_batch_set(&copies[1], 0);
+	copy_batch_set(&copies[2], offset + 2 * page_size);
+	batch.nr = 3;
+	batch.copied = -1;
+	if (!ioctl(uffd, UFFDIO_COPY_BATCH, &batch))
+		err("UFFDIO_COPY_BATCH succeeded on a populated page");
+	if (errno != EEXIST)
+		err("UFFDIO_COPY_BATCH not -EEXIST");
+	if (batch.copied != 1)
+		err("UFFDIO_COPY_BATCH copied %"PRId64", expected 1",
+		    (int64_t)batch.copied);
+	if (copies[0].copy != page_size || copies[1].copy != -EEXIST ||
+	    copies[2].copy != 0)
+		err("UFFDIO_COPY_BATCH unexpected copy results: %"PRId64
+		    " %"PRId64" %"PRId64, (int64_t)copies[0].copy,
+		    (int64_t)copies[1].copy, (int64_t)copies[2].copy);
+	if (memcmp(area_dst + offset, area_src + offset, page_size))
+		err("page %lu not copied", offset / page_size);
+
+	/* Rejected requests report that nothing was copied */
+	batch.nr = 0;
+	batch.copied = -1;
+	if (!ioctl(uffd, UFFDIO_COPY_BATCH, &batch))
+		err("UFFDIO_COPY_BATCH succeeded without entries");
+	if (errno != EINVAL)
+		err("UFFDIO_COPY_BATCH not -EINVAL");
+	if (batch.copied != 0)
+		err("UFFDIO_COPY_BATCH copied %"PRId64", expected 0",
+		    (int64_t)batch.copied);
+
+	if (uffd_unregister(uffd, area_dst, nr_pages * page_size))
+		err("unregister");
+
+	uffd_test_pass();
+}
+
 static void uffd_register_poison(int uffd, void *addr, uint64_t len)
 {
 	uint64_t ioctls = 0;
@@ -1340,6 +1468,12 @@ uffd_test_case_t uffd_tests[] = {
 		.mem_targets = MEM_ALL,
 		.uffd_feature_required = 0,
 	},
+	{
+		.name = "copy-batch",
+		.uffd_fn = uffd_copy_batch_test,
+		.mem_targets = MEM_ALL,
+		.uffd_feature_required = 0,
+	},
 	{
 		.name = "move",
 		.uffd_fn = uffd_move_test,